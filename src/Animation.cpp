@@ -1,34 +1,79 @@
 #include "Animation.h"
 #include <cassert>
+#include <unordered_map>
 
 namespace flat2d {
-	void Animation::start() { animationTimer.start(); }
+	Uint32 AnimationClock::time = 0;
+	float AnimationClock::remainder = 0.0f;
 
-	void Animation::stop() { animationTimer.stop(); }
+	void AnimationClock::advance(float seconds)
+	{
+		// Keep the fractions of milliseconds to avoid drifting
+		remainder += seconds * 1000.0f;
+		Uint32 ms = static_cast<Uint32>(remainder);
+		remainder -= ms;
+		time += ms;
+	}
+
+	Uint32 AnimationClock::getTime() { return time; }
+
+	void AnimationClock::reset()
+	{
+		time = 0;
+		remainder = 0.0f;
+	}
+
+	AnimationId Animation::intern(const std::string& name)
+	{
+		static std::unordered_map<std::string, AnimationId> ids;
+		auto it = ids.find(name);
+		if (it != ids.end()) {
+			return it->second;
+		}
+		AnimationId id = static_cast<AnimationId>(ids.size() + 1);
+		ids[name] = id;
+		return id;
+	}
 
-	bool Animation::isRunning() const { return animationTimer.isStarted(); }
+	const AnimationDefinitionPtr& Animation::getDefinition() const
+	{
+		return definition;
+	}
+
+	void Animation::start()
+	{
+		startTime = AnimationClock::getTime();
+		running = true;
+	}
+
+	void Animation::stop() { running = false; }
+
+	bool Animation::isRunning() const { return running; }
 
 	const SDL_Rect* Animation::run()
 	{
+		const Clips& clips = definition->getClips();
 		assert(!clips.empty());
 
-		if (!animationTimer.isStarted()) {
+		if (!running) {
 			return &clips[0];
 		}
 
-		if (animationTimer.getTicks() >= timestep) {
+		Uint32 timestep = definition->getTimestep();
+		if (timestep == 0) {
+			// No timestep, step one clip per run
 			clipIndex++;
-			animationTimer.stop();
-			animationTimer.start();
+		} else {
+			clipIndex = (AnimationClock::getTime() - startTime) / timestep;
 		}
 
-		clipIndex = clipIndex % clips.size();
-
 		// Stay at the last clip, if runs once
-		if (runOnce && clipIndex == clips.size() - 1) {
-			animationTimer.stop();
+		if (runOnce && clipIndex >= clips.size() - 1) {
+			clipIndex = clips.size() - 1;
+			running = false;
 		}
 
+		clipIndex = clipIndex % clips.size();
 		return &clips[clipIndex];
 	}
 
@@ -37,9 +82,9 @@ namespace flat2d {
 	void Animation::reset(bool alsoStart)
 	{
 		clipIndex = 0;
-		animationTimer.stop();
+		running = false;
 		if (alsoStart) {
-			animationTimer.start();
+			start();
 		}
 	}
 } // namespace flat2d
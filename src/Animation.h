@@ -1,36 +1,118 @@
 #ifndef ANIMATION_H_
 #define ANIMATION_H_
 
-#include "Timer.h"
 #include <SDL.h>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace flat2d {
 	typedef std::vector<SDL_Rect> Clips;
+	typedef Uint32 AnimationId;
+
+	/**
+	 * The time all Animation objects are played by. It's advanced with the
+	 * frame deltatime by the GameEngine so animations follow game time,
+	 * including fixed timesteps and input playback, rather than the wall
+	 * clock.
+	 */
+	class AnimationClock
+	{
+	  private:
+		static Uint32 time;
+		static float remainder;
+
+	  public:
+		/**
+		 * Advance the clock. Called by the GameEngine every frame.
+		 * @param seconds The time to advance in seconds
+		 */
+		static void advance(float seconds);
+
+		/**
+		 * Get the clock time
+		 * @return The time in milliseconds
+		 */
+		static Uint32 getTime();
+
+		/**
+		 * Reset the clock to 0
+		 */
+		static void reset();
+	};
+
+	/**
+	 * The immutable part of an Animation, its clips and timestep. A
+	 * definition can be shared by any number of Animation objects so
+	 * entities using the same animation don't hold copies of the clips.
+	 */
+	class AnimationDefinition
+	{
+	  private:
+		const Clips clips;
+		const Uint32 timestep;
+		const bool runOnce;
+
+	  public:
+		AnimationDefinition(const Clips& c, Uint32 t, bool once = false)
+		  : clips(c)
+		  , timestep(t)
+		  , runOnce(once)
+		{}
+
+		const Clips& getClips() const { return clips; }
+
+		Uint32 getTimestep() const { return timestep; }
+
+		bool isRunOnce() const { return runOnce; }
+	};
+
+	typedef std::shared_ptr<const AnimationDefinition> AnimationDefinitionPtr;
 
 	/**
 	 * An animation to use. Animations are essentially a set of clips
 	 * (squares(x, y, w, h)) and a timestep. Calling the run function on an
 	 * Animation will return the current "clip" to use on your texture.
+	 * The clips are held by a shared AnimationDefinition and the current
+	 * clip is derived from the AnimationClock.
 	 * @author Linus Probert <linus.probert@gmail.com>
 	 */
 	class Animation
 	{
 	  private:
-		Timer animationTimer;
+		AnimationDefinitionPtr definition;
 
-		Clips clips;
-		uint32_t timestep;
-		int clipIndex = 0;
+		Uint32 startTime = 0;
+		unsigned int clipIndex = 0;
+		bool running = false;
 		bool runOnce = false;
 
 	  public:
 		Animation(Clips& c, uint32_t t, bool once = false)
-		  : clips(c)
-		  , timestep(t)
+		  : definition(std::make_shared<AnimationDefinition>(c, t, once))
 		  , runOnce(once)
 		{}
 
+		explicit Animation(const AnimationDefinitionPtr& def)
+		  : definition(def)
+		  , runOnce(def->isRunOnce())
+		{}
+
+		/**
+		 * Get the id for an animation name. The same name always gives the
+		 * same id. Use the ids to avoid string handling when starting
+		 * animations every frame.
+		 * @param name The animation name
+		 * @return The interned id
+		 */
+		static AnimationId intern(const std::string& name);
+
+		/**
+		 * Get the shared definition of the animation
+		 * @return The AnimationDefinition
+		 */
+		const AnimationDefinitionPtr& getDefinition() const;
+
 		/**
 		 * Run the animation and get the current clip
 		 * @return the current clip represented as an SDL_Rect
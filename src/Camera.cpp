@@ -36,16 +36,22 @@ namespace flat2d {
 
 	bool Camera::isVisibleOnCamera(const SDL_Rect& box, int depth)
 	{
-		int bx = getScreenXposFor(box.x, depth);
-		int by = getScreenYposFor(box.y, depth);
+		SDL_Rect screenBox = { getScreenXposFor(box.x, depth),
+			                   getScreenYposFor(box.y, depth),
+			                   box.w,
+			                   box.h };
+		return isVisibleOnScreen(screenBox);
+	}
 
-		if (bx > w) {
+	bool Camera::isVisibleOnScreen(const SDL_Rect& box) const
+	{
+		if (box.x > w) {
 			return false;
-		} else if (bx + box.w < 0) {
+		} else if (box.x + box.w < 0) {
 			return false;
-		} else if (by > h) {
+		} else if (box.y > h) {
 			return false;
-		} else if (by + box.h < 0) {
+		} else if (box.y + box.h < 0) {
 			return false;
 		}
 		return true;
@@ -72,4 +78,14 @@ namespace flat2d {
 		}
 		return ypos - y;
 	}
+
+	SDL_Point Camera::getOffsetFor(int depth) const
+	{
+		SDL_Point offset = { x, y };
+		if (depth > 0) {
+			offset.x = (int)(x / (1.5 * depth));
+			offset.y = y / (5 * depth);
+		}
+		return offset;
+	}
 } // namespace flat2d
@@ -67,6 +67,13 @@ namespace flat2d {
 		 */
 		bool isVisibleOnCamera(const SDL_Rect& box, int depth = 0);
 
+		/**
+		 * Check if a "box" already in screen coordinates is visible
+		 * @param box The x,y,w,h to check
+		 * @return true or false
+		 */
+		bool isVisibleOnScreen(const SDL_Rect& box) const;
+
 		/**
 		 * Check if a "box" is within camera map bounds
 		 * @param rect The x,y,w,h to check
@@ -89,6 +96,15 @@ namespace flat2d {
 		 * @return true or false
 		 */
 		int getScreenYposFor(int y, int depth = 0) const;
+
+		/**
+		 * Get the offset subtracted from world positions at a depth to get
+		 * screen positions. Prefer RenderData::getCameraOffset while
+		 * rendering, it's computed once per frame.
+		 * @param depth The depth
+		 * @return The x and y offset
+		 */
+		SDL_Point getOffsetFor(int depth = 0) const;
 	};
 } // namespace flat2d
 
@@ -16,16 +16,16 @@ namespace flat2d {
 	void CollisionDetector::handlePossibleCollisionsFor(Entity* e,
 	                                                    const GameData* data)
 	{
-		entityContainer->iterateCollidablesFor(e, [this, e, data](Entity* o) {
-			EntityShape broadphaseShape =
-			  e->getEntityProperties().getVelocityColliderShape(
-			    dtMonitor->getDeltaTime());
-			if (this->AABB(broadphaseShape,
-			               o->getEntityProperties().getColliderShape())) {
-				this->handlePossibleCollision(e, o, data);
-			}
-			return false;
-		});
+		filteredPairCount += entityContainer->iterateCollidablesFor(
+		  e, [this, e, data](Entity* o) {
+			  EntityShape broadphaseShape =
+			    e->getEntityProperties().getVelocityColliderShape(
+			      dtMonitor->getDeltaTime());
+			  if (this->AABB(broadphaseShape,
+			                 o->getEntityProperties().getColliderShape())) {
+				  this->handlePossibleCollision(e, o, data);
+			  }
+		  });
 	}
 
 	bool CollisionDetector::handlePossibleCollision(Entity* o1,
@@ -67,6 +67,12 @@ namespace flat2d {
 			collided = true;
 		}
 
+		if (collided) {
+			props1.wake();
+			props2.wake();
+			entityContainer->getContactManager().addContact(o1, o2);
+		}
+
 		return collided;
 	}
 
@@ -82,83 +88,168 @@ namespace flat2d {
 	                                   float* normalx,
 	                                   float* normaly) const
 	{
-		EntityShape b1 = p1->getColliderShape();
-		EntityShape b2 = p2->getColliderShape();
+		float deltatime = dtMonitor->getDeltaTime();
+		return sweptAABB(p1->getColliderShape(),
+		                 p1->getXvel() * deltatime,
+		                 p1->getYvel() * deltatime,
+		                 p2->getColliderShape(),
+		                 normalx,
+		                 normaly);
+	}
 
-		float xvel = p1->getXvel() * dtMonitor->getDeltaTime();
-		float yvel = p1->getYvel() * dtMonitor->getDeltaTime();
+	float CollisionDetector::sweptAABB(const EntityShape& b1,
+	                                   float dx,
+	                                   float dy,
+	                                   const EntityShape& b2,
+	                                   float* normalx,
+	                                   float* normaly) const
+	{
+		const float infinity = std::numeric_limits<float>::infinity();
 
-		// Find the distances to the blocking object
-		float xInvEntry, xInvExit;
-		float yInvEntry, yInvExit;
+		*normalx = 0.0f;
+		*normaly = 0.0f;
 
-		if (xvel > 0.0f) {
-			xInvEntry = static_cast<float>(b2.x - (b1.x + b1.w + 2));
-			xInvExit = static_cast<float>((b2.x + b2.w) - (b1.x - 2));
+		// Find the impact and exit times for each axis. A stationary axis
+		// either always overlaps or never does.
+		float xEntry, xExit;
+		if (dx > 0.0f) {
+			xEntry = static_cast<float>(b2.x - (b1.x + b1.w)) / dx;
+			xExit = static_cast<float>((b2.x + b2.w) - b1.x) / dx;
+		} else if (dx < 0.0f) {
+			xEntry = static_cast<float>((b2.x + b2.w) - b1.x) / dx;
+			xExit = static_cast<float>(b2.x - (b1.x + b1.w)) / dx;
+		} else if (b1.x > b2.x + b2.w || b1.x + b1.w < b2.x) {
+			return 1.0f;
 		} else {
-			xInvEntry = static_cast<float>((b2.x + b2.w) - (b1.x - 2));
-			xInvExit = static_cast<float>(b2.x - (b1.x + b1.w + 2));
+			xEntry = -infinity;
+			xExit = infinity;
 		}
 
-		if (yvel > 0.0f) {
-			yInvEntry = static_cast<float>(b2.y - (b1.y + b1.w + 2));
-			yInvExit = static_cast<float>((b2.y + b2.w) - (b1.y - 2));
+		float yEntry, yExit;
+		if (dy > 0.0f) {
+			yEntry = static_cast<float>(b2.y - (b1.y + b1.h)) / dy;
+			yExit = static_cast<float>((b2.y + b2.h) - b1.y) / dy;
+		} else if (dy < 0.0f) {
+			yEntry = static_cast<float>((b2.y + b2.h) - b1.y) / dy;
+			yExit = static_cast<float>(b2.y - (b1.y + b1.h)) / dy;
+		} else if (b1.y > b2.y + b2.h || b1.y + b1.h < b2.y) {
+			return 1.0f;
 		} else {
-			yInvEntry = static_cast<float>((b2.y + b2.w) - (b1.y - 2));
-			yInvExit = static_cast<float>(b2.y - (b1.y + b1.w + 2));
+			yEntry = -infinity;
+			yExit = infinity;
 		}
 
-		// Find the impact time
-		float xEntry, xExit;
-		float yEntry, yExit;
+		// Find earliest/latest times of collision
+		float entryTime = std::max(xEntry, yEntry);
+		float exitTime = std::min(xExit, yExit);
 
-		if (xvel == 0.0f) {
-			xEntry = -std::numeric_limits<float>::infinity();
-			xExit = std::numeric_limits<float>::infinity();
-		} else {
-			xEntry = xInvEntry / xvel;
-			xExit = xInvExit / xvel;
+		// No impact during this move or the shapes already overlap
+		if (entryTime > exitTime || entryTime < 0.0f || entryTime >= 1.0f) {
+			return 1.0f;
 		}
 
-		if (yvel == 0.0f) {
-			yEntry = -std::numeric_limits<float>::infinity();
-			yExit = std::numeric_limits<float>::infinity();
+		if (xEntry > yEntry) {
+			*normalx = dx > 0.0f ? -1.0f : 1.0f;
 		} else {
-			yEntry = yInvEntry / yvel;
-			yExit = yInvExit / yvel;
+			*normaly = dy > 0.0f ? -1.0f : 1.0f;
 		}
+		return entryTime;
+	}
 
-		// Find earliest/latest times of collision
-		float entryTime = std::max(xEntry, yEntry);
-		float exitTime = std::min(xExit, yExit);
+	unsigned int CollisionDetector::getFilteredPairCount() const
+	{
+		return filteredPairCount;
+	}
 
-		if (entryTime > exitTime || (xEntry < 0.0f && yEntry < 0.0f) ||
-		    xEntry > 1.0f || yEntry > 1.0f) {
-			// No collision
-			*normalx = 0.0f;
-			*normaly = 0.0f;
-			return 1.0f;
+	void CollisionDetector::resetFilteredPairCount() { filteredPairCount = 0; }
+
+	void CollisionDetector::handleContinuousMovementFor(Entity* e,
+	                                                    const GameData* data)
+	{
+		EntityProperties& props = e->getEntityProperties();
+		float deltatime = dtMonitor->getDeltaTime();
+		float remaining = 1.0f;
+
+		impactedEntities.clear();
+		for (int i = 0; i < MAX_IMPACTS && props.isMoving(); i++) {
+			int dx = static_cast<int>(props.getXvel() * deltatime * remaining);
+			int dy = static_cast<int>(props.getYvel() * deltatime * remaining);
+			if (dx == 0 && dy == 0) {
+				break;
+			}
 
+			// Sweep the rest of the movement against everything in its way
+			EntityShape shape = props.getColliderShape();
+			EntityShape sweep = { std::min(shape.x, shape.x + dx),
+				                  std::min(shape.y, shape.y + dy),
+				                  shape.w + std::abs(dx),
+				                  shape.h + std::abs(dy) };
+			impacts.clear();
+			filteredPairCount += entityContainer->iterateCollidablesOverlapping(
+			  e, sweep, [this, &shape, dx, dy](Entity* o) {
+				  if (std::find(impactedEntities.begin(),
+				                impactedEntities.end(),
+				                o) != impactedEntities.end()) {
+					  return;
+				  }
+
+				  Impact impact;
+				  impact.entity = o;
+				  impact.time =
+				    sweptAABB(shape,
+				              static_cast<float>(dx),
+				              static_cast<float>(dy),
+				              o->getEntityProperties().getColliderShape(),
+				              &impact.normalx,
+				              &impact.normaly);
+				  if (impact.time < 1.0f) {
+					  impacts.push_back(impact);
+				  }
+			  });
+
+			if (impacts.empty()) {
+				props.incrementXpos(dx);
+				props.incrementYpos(dy);
+				break;
+			}
+
+			// Resolve the earliest impact and sweep what's left of the move
+			Impact first = *std::min_element(impacts.begin(), impacts.end());
+			props.incrementXpos(static_cast<int>(dx * first.time));
+			props.incrementYpos(static_cast<int>(dy * first.time));
+			impactedEntities.push_back(first.entity);
+			handleImpact(e, first, data);
+			remaining *= 1.0f - first.time;
+		}
+	}
+
+	void CollisionDetector::handleImpact(Entity* o1,
+	                                     const Impact& impact,
+	                                     const GameData* data)
+	{
+		Entity* o2 = impact.entity;
+		EntityProperties& props1 = o1->getEntityProperties();
+		EntityProperties& props2 = o2->getEntityProperties();
+
+		if (impact.normalx != 0.0f) {
+			if (!o1->onCollision(o2, data) &&
+			    !o1->onHorizontalCollision(o2, data)) {
+				handleHorizontalCollisions(&props1, &props2);
+			}
+			o2->onCollision(o1, data);
+			o2->onHorizontalCollision(o1, data);
 		} else {
-			if (xEntry > yEntry) {
-				if (xInvEntry < 0.0f) {
-					*normalx = 1.0f;
-					*normaly = 0.0f;
-				} else {
-					*normalx = -1.0f;
-					*normaly = 0.0f;
-				}
-			} else {
-				if (yInvEntry < 0.0f) {
-					*normalx = 0.0f;
-					*normaly = 1.0f;
-				} else {
-					*normalx = 0.0f;
-					*normaly = -1.0f;
-				}
+			if (!o1->onCollision(o2, data) &&
+			    !o1->onVerticalCollision(o2, data)) {
+				handleVerticalCollisions(&props1, &props2);
 			}
+			o2->onCollision(o1, data);
+			o2->onVerticalCollision(o1, data);
 		}
-		return entryTime;
+
+		props1.wake();
+		props2.wake();
+		entityContainer->getContactManager().addContact(o1, o2);
 	}
 
 	void CollisionDetector::handleHorizontalCollisions(
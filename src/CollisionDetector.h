@@ -1,6 +1,8 @@
 #ifndef COLLISIONDETECTOR_H_
 #define COLLISIONDETECTOR_H_
 
+#include <vector>
+
 #include "EntityShape.h"
 
 namespace flat2d {
@@ -18,10 +20,26 @@ namespace flat2d {
 	class CollisionDetector
 	{
 	  private:
+		struct Impact
+		{
+			float time;
+			float normalx;
+			float normaly;
+			Entity* entity;
+
+			bool operator<(const Impact& o) const { return time < o.time; }
+		};
+
 		EntityContainer* entityContainer;
 		DeltatimeMonitor* dtMonitor;
+		static const int MAX_IMPACTS = 8;
+
+		unsigned int filteredPairCount = 0;
+		std::vector<Impact> impacts;
+		std::vector<Entity*> impactedEntities;
 
 		bool handlePossibleCollision(Entity*, Entity*, const GameData* data);
+		void handleImpact(Entity*, const Impact&, const GameData* data);
 
 		void handleHorizontalCollisions(EntityProperties* props1,
 		                                EntityProperties* props2) const;
@@ -61,6 +79,34 @@ namespace flat2d {
 		 */
 		void handlePossibleCollisionsFor(Entity* entity, const GameData* data);
 
+		/**
+		 * Move an Entity with continuous collision detection. The whole
+		 * movement of the frame is swept against the collidables
+		 * overlapping the swept collider and the earliest impact is
+		 * resolved with the normal collision handling. The rest of the
+		 * movement, with the velocity left after the impact, is then swept
+		 * again. Etheral bodies keep moving through what they hit. Each
+		 * Entity is hit at most once per frame. Used by EntityContainer for
+		 * Entities with continuous collision enabled, avoid using in game
+		 * code.
+		 * @param entity The entity to move
+		 * @param data The GameData object
+		 */
+		void handleContinuousMovementFor(Entity* entity, const GameData* data);
+
+		/**
+		 * Get the number of broadphase pairs rejected by the collision
+		 * category and mask filter since the last reset. Useful for
+		 * profiling.
+		 * @return The number of filtered pairs
+		 */
+		unsigned int getFilteredPairCount() const;
+
+		/**
+		 * Reset the filtered pair counter
+		 */
+		void resetFilteredPairCount();
+
 		/**
 		 * AABB Collision detection between two EntityShape objects.
 		 * This is public due to testing. Let the EntityContainer use it alone
@@ -70,14 +116,39 @@ namespace flat2d {
 		bool AABB(const EntityShape&, const EntityShape&) const;
 
 		/**
-		 * AABB sweeping collision detection between two EntityShape objects.
+		 * AABB sweeping collision detection between two EntityProperties
+		 * objects using the current deltatime. The first object is moving,
+		 * the second is considered stationary.
 		 * This is public due to testing. Let the EntityContainer use it alone.
-		 * This actually isn't used at the moment because it's a bit broken.
+		 * @param props1 The moving EntityProperties
+		 * @param props2 The stationary EntityProperties
+		 * @param normalx Set to the x component of the impact normal
+		 * @param normaly Set to the y component of the impact normal
+		 * @return The time of impact in [0, 1) or 1 if there is no impact
 		 */
 		float sweptAABB(EntityProperties* props1,
 		                EntityProperties* props2,
 		                float* normalx,
 		                float* normaly) const;
+
+		/**
+		 * AABB sweeping collision detection of an EntityShape moving by
+		 * (dx, dy) against a stationary EntityShape. Shapes that touch are
+		 * considered colliding just like in AABB.
+		 * @param b1 The moving EntityShape
+		 * @param dx The x movement
+		 * @param dy The y movement
+		 * @param b2 The stationary EntityShape
+		 * @param normalx Set to the x component of the impact normal
+		 * @param normaly Set to the y component of the impact normal
+		 * @return The time of impact in [0, 1) or 1 if there is no impact
+		 */
+		float sweptAABB(const EntityShape& b1,
+		                float dx,
+		                float dy,
+		                const EntityShape& b2,
+		                float* normalx,
+		                float* normaly) const;
 	};
 } // namespace flat2d
 
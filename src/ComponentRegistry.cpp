@@ -0,0 +1,174 @@
+#include <algorithm>
+
+#include "ComponentRegistry.h"
+#include "Entity.h"
+#include "UID.h"
+
+namespace flat2d {
+	static std::vector<size_t>& typeSizes()
+	{
+		static std::vector<size_t> sizes;
+		return sizes;
+	}
+
+	ComponentType ComponentRegistry::registerType(size_t size)
+	{
+		std::vector<size_t>& sizes = typeSizes();
+		assert(sizes.size() < sizeof(ComponentMask) * 8);
+		sizes.push_back(size);
+		return static_cast<ComponentType>(sizes.size() - 1);
+	}
+
+	size_t ComponentRegistry::getTypeSize(ComponentType type)
+	{
+		return typeSizes()[type];
+	}
+
+	ComponentRegistry::ComponentRegistry()
+	{
+		// Entities without components live in the first archetype
+		findArchetype(0);
+	}
+
+	size_t ComponentRegistry::findArchetype(ComponentMask mask)
+	{
+		auto it = archetypeIndex.find(mask);
+		if (it != archetypeIndex.end()) {
+			return it->second;
+		}
+
+		Archetype archetype;
+		archetype.mask = mask;
+		for (ComponentType type = 0; type < sizeof(ComponentMask) * 8;
+		     type++) {
+			if ((mask & (ComponentMask(1) << type)) != 0) {
+				archetype.types.push_back(type);
+			}
+		}
+		archetype.columns.resize(archetype.types.size());
+
+		archetypes.push_back(archetype);
+		archetypeIndex[mask] = archetypes.size() - 1;
+		return archetypes.size() - 1;
+	}
+
+	void ComponentRegistry::moveEntity(const EntityKey& key, ComponentMask mask)
+	{
+		Record record = records[key];
+		size_t target = findArchetype(mask);
+		Archetype& from = archetypes[record.archetype];
+		Archetype& to = archetypes[target];
+
+		// Append a row to the target, copying the components both share
+		size_t row = to.entities.size();
+		to.entities.push_back(key);
+		for (size_t i = 0; i < to.types.size(); i++) {
+			size_t size = getTypeSize(to.types[i]);
+			std::vector<unsigned char>& column = to.columns[i];
+			column.resize(column.size() + size);
+
+			auto source =
+			  std::find(from.types.begin(), from.types.end(), to.types[i]);
+			if (source != from.types.end()) {
+				const std::vector<unsigned char>& fromColumn =
+				  from.columns[source - from.types.begin()];
+				std::memcpy(&column[row * size],
+				            &fromColumn[record.row * size],
+				            size);
+			} else {
+				std::memset(&column[row * size], 0, size);
+			}
+		}
+
+		removeRow(record.archetype, record.row);
+		records[key] = { target, row };
+	}
+
+	void ComponentRegistry::removeRow(size_t index, size_t row)
+	{
+		// Fill the hole with the last row to keep the columns contiguous
+		Archetype& archetype = archetypes[index];
+		size_t last = archetype.entities.size() - 1;
+		for (size_t i = 0; i < archetype.types.size(); i++) {
+			size_t size = getTypeSize(archetype.types[i]);
+			std::vector<unsigned char>& column = archetype.columns[i];
+			if (row != last) {
+				std::memcpy(&column[row * size], &column[last * size], size);
+			}
+			column.resize(column.size() - size);
+		}
+
+		if (row != last) {
+			EntityKey moved = archetype.entities[last];
+			archetype.entities[row] = moved;
+			records[moved].row = row;
+		}
+		archetype.entities.pop_back();
+	}
+
+	unsigned char* ComponentRegistry::getComponent(const EntityKey& key,
+	                                               ComponentType type)
+	{
+		auto it = records.find(key);
+		if (it == records.end()) {
+			return nullptr;
+		}
+
+		Archetype& archetype = archetypes[it->second.archetype];
+		size_t offset = it->second.row * getTypeSize(type);
+		for (size_t i = 0; i < archetype.types.size(); i++) {
+			if (archetype.types[i] == type) {
+				return &archetype.columns[i][offset];
+			}
+		}
+		return nullptr;
+	}
+
+	EntityKey ComponentRegistry::create()
+	{
+		EntityKey key(UID::generate());
+		records[key] = { 0, archetypes[0].entities.size() };
+		archetypes[0].entities.push_back(key);
+		return key;
+	}
+
+	EntityKey ComponentRegistry::bridge(Entity* entity)
+	{
+		EntityKey key = entity->getKey();
+		add(key, EntityRef{ entity });
+		return key;
+	}
+
+	void ComponentRegistry::destroy(const EntityKey& key)
+	{
+		auto it = records.find(key);
+		if (it == records.end()) {
+			return;
+		}
+		removeRow(it->second.archetype, it->second.row);
+		records.erase(key);
+	}
+
+	bool ComponentRegistry::contains(const EntityKey& key) const
+	{
+		return records.find(key) != records.end();
+	}
+
+	size_t ComponentRegistry::getEntityCount() const { return records.size(); }
+
+	size_t ComponentRegistry::getArchetypeCount() const
+	{
+		return archetypes.size();
+	}
+
+	void ComponentRegistry::clear()
+	{
+		for (auto& archetype : archetypes) {
+			archetype.entities.clear();
+			for (auto& column : archetype.columns) {
+				column.clear();
+			}
+		}
+		records.clear();
+	}
+} // namespace flat2d
@@ -0,0 +1,285 @@
+#ifndef COMPONENTREGISTRY_H_
+#define COMPONENTREGISTRY_H_
+
+#include <SDL.h>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "EntityKey.h"
+
+namespace flat2d {
+	class Entity;
+
+	typedef Uint32 ComponentType;
+	typedef Uint64 ComponentMask;
+
+	/**
+	 * The component linking a legacy Entity to its components, see
+	 * ComponentRegistry::bridge
+	 */
+	struct EntityRef
+	{
+		Entity* entity;
+	};
+
+	/**
+	 * An optional archetype based component storage that sits alongside
+	 * the EntityContainer. Entities are plain keys and their components
+	 * are stored in tables, one per combination of component types
+	 * (archetype), with one contiguous column per component type. Systems
+	 * iterate the tables holding the components they ask for and only
+	 * touch that data.
+	 *
+	 * Components have to be trivially copyable structs, there can be at
+	 * most 64 component types. Don't add, remove or destroy while
+	 * iterating.
+	 */
+	class ComponentRegistry
+	{
+	  private:
+		struct Archetype
+		{
+			ComponentMask mask;
+			std::vector<ComponentType> types;
+			std::vector<std::vector<unsigned char>> columns;
+			std::vector<EntityKey> entities;
+		};
+
+		struct Record
+		{
+			size_t archetype;
+			size_t row;
+		};
+
+		std::vector<Archetype> archetypes;
+		std::unordered_map<ComponentMask, size_t> archetypeIndex;
+		std::unordered_map<EntityKey, Record> records;
+
+		ComponentRegistry(const ComponentRegistry&); // Don't implement
+		void operator=(const ComponentRegistry&);    // Don't implement
+
+		static ComponentType registerType(size_t size);
+		static size_t getTypeSize(ComponentType type);
+
+		size_t findArchetype(ComponentMask mask);
+		void moveEntity(const EntityKey& key, ComponentMask mask);
+		void removeRow(size_t archetype, size_t row);
+		unsigned char* getComponent(const EntityKey& key, ComponentType type);
+
+		template<typename T>
+		static T* column(Archetype& archetype)
+		{
+			ComponentType type = typeId<T>();
+			for (size_t i = 0; i < archetype.types.size(); i++) {
+				if (archetype.types[i] == type) {
+					return reinterpret_cast<T*>(archetype.columns[i].data());
+				}
+			}
+			return nullptr;
+		}
+
+		template<typename F, typename... Columns>
+		static void iterate(Archetype& archetype, F& func, Columns... columns)
+		{
+			for (size_t i = 0; i < archetype.entities.size(); i++) {
+				func(archetype.entities[i], columns[i]...);
+			}
+		}
+
+		static ComponentMask maskOf() { return 0; }
+
+		template<typename T, typename... Ts>
+		static ComponentMask maskOf(const T*, const Ts*... rest)
+		{
+			return (ComponentMask(1) << typeId<T>()) | maskOf(rest...);
+		}
+
+		template<typename... Ts>
+		static ComponentMask queryMask()
+		{
+			return maskOf(static_cast<const Ts*>(nullptr)...);
+		}
+
+	  public:
+		ComponentRegistry();
+
+		/**
+		 * Get the id of a component type. Ids are assigned on first use.
+		 * @return The ComponentType
+		 */
+		template<typename T>
+		static ComponentType typeId()
+		{
+			static_assert(std::is_trivially_copyable<T>::value,
+			              "Components must be trivially copyable");
+			static_assert(alignof(T) <= alignof(std::max_align_t),
+			              "Components can't be over aligned");
+			static const ComponentType type = registerType(sizeof(T));
+			return type;
+		}
+
+		/**
+		 * Create an entity without components
+		 * @return The key of the new entity
+		 */
+		EntityKey create();
+
+		/**
+		 * Bridge a legacy Entity. The Entity key gets an EntityRef
+		 * component pointing at the Entity so systems can reach it
+		 * together with other components. An EntityContainer given this
+		 * registry destroys the key when it deletes the Entity.
+		 * @param entity The Entity
+		 * @return The key of the Entity
+		 */
+		EntityKey bridge(Entity* entity);
+
+		/**
+		 * Destroy an entity and its components
+		 * @param key The entity
+		 */
+		void destroy(const EntityKey& key);
+
+		/**
+		 * Check if an entity exists in the registry
+		 * @param key The entity
+		 * @return true or false
+		 */
+		bool contains(const EntityKey& key) const;
+
+		/**
+		 * Add a component, or replace it if the entity already has one.
+		 * Adding moves the entity to the archetype of its new component
+		 * set. Unknown keys are created.
+		 * @param key The entity
+		 * @param component The component
+		 * @return The stored component
+		 */
+		template<typename T>
+		T* add(const EntityKey& key, const T& component)
+		{
+			ComponentType type = typeId<T>();
+			auto it = records.find(key);
+			if (it == records.end()) {
+				records[key] = { 0, archetypes[0].entities.size() };
+				archetypes[0].entities.push_back(key);
+				it = records.find(key);
+			}
+
+			ComponentMask bit = ComponentMask(1) << type;
+			ComponentMask mask = archetypes[it->second.archetype].mask;
+			if ((mask & bit) == 0) {
+				moveEntity(key, mask | bit);
+			}
+
+			T* stored = reinterpret_cast<T*>(getComponent(key, type));
+			std::memcpy(stored, &component, sizeof(T));
+			return stored;
+		}
+
+		/**
+		 * Remove a component from an entity
+		 * @param key The entity
+		 */
+		template<typename T>
+		void remove(const EntityKey& key)
+		{
+			auto it = records.find(key);
+			if (it == records.end()) {
+				return;
+			}
+
+			ComponentMask bit = ComponentMask(1) << typeId<T>();
+			ComponentMask mask = archetypes[it->second.archetype].mask;
+			if ((mask & bit) != 0) {
+				moveEntity(key, mask & ~bit);
+			}
+		}
+
+		/**
+		 * Get a component of an entity. The pointer is invalidated when
+		 * components are added to or removed from any entity.
+		 * @param key The entity
+		 * @return The component or nullptr
+		 */
+		template<typename T>
+		T* get(const EntityKey& key)
+		{
+			return reinterpret_cast<T*>(getComponent(key, typeId<T>()));
+		}
+
+		/**
+		 * Check if an entity has a component
+		 * @param key The entity
+		 * @return true or false
+		 */
+		template<typename T>
+		bool has(const EntityKey& key) const
+		{
+			auto it = records.find(key);
+			return it != records.end() &&
+			       (archetypes[it->second.archetype].mask &
+			        (ComponentMask(1) << typeId<T>())) != 0;
+		}
+
+		/**
+		 * Call a function for every entity having all the given
+		 * components: func(EntityKey key, Ts&... components)
+		 * @param func The function
+		 */
+		template<typename... Ts, typename F>
+		void each(F func)
+		{
+			ComponentMask mask = queryMask<Ts...>();
+			for (auto& archetype : archetypes) {
+				if ((archetype.mask & mask) == mask &&
+				    !archetype.entities.empty()) {
+					iterate(archetype, func, column<Ts>(archetype)...);
+				}
+			}
+		}
+
+		/**
+		 * Call a function once per archetype having all the given
+		 * components with the arrays of the archetype:
+		 * func(size_t count, const EntityKey* keys, Ts*... components)
+		 * @param func The function
+		 */
+		template<typename... Ts, typename F>
+		void eachChunk(F func)
+		{
+			ComponentMask mask = queryMask<Ts...>();
+			for (auto& archetype : archetypes) {
+				if ((archetype.mask & mask) == mask &&
+				    !archetype.entities.empty()) {
+					func(archetype.entities.size(),
+					     archetype.entities.data(),
+					     column<Ts>(archetype)...);
+				}
+			}
+		}
+
+		/**
+		 * Get the number of entities in the registry
+		 * @return The entity count
+		 */
+		size_t getEntityCount() const;
+
+		/**
+		 * Get the number of archetypes created
+		 * @return The archetype count
+		 */
+		size_t getArchetypeCount() const;
+
+		/**
+		 * Destroy all entities
+		 */
+		void clear();
+	};
+} // namespace flat2d
+
+#endif // COMPONENTREGISTRY_H_
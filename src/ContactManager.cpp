@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <vector>
+
+#include "ContactManager.h"
+#include "Entity.h"
+
+namespace flat2d {
+	ContactManager::ContactKey ContactManager::createKey(const Entity* e1,
+	                                                     const Entity* e2)
+	{
+		ContactKey key = { e1->getKey(), e2->getKey() };
+		if (key.second < key.first) {
+			std::swap(key.first, key.second);
+		}
+		return key;
+	}
+
+	bool ContactManager::orderEvents(const ContactEvent& e1,
+	                                 const ContactEvent& e2)
+	{
+		return createKey(e1.entityA, e1.entityB) <
+		       createKey(e2.entityA, e2.entityB);
+	}
+
+	bool ContactManager::isRemovedDuringDispatch(const Entity* entity) const
+	{
+		return std::find(removedDuringDispatch.begin(),
+		                 removedDuringDispatch.end(),
+		                 entity) != removedDuringDispatch.end();
+	}
+
+	void ContactManager::addContact(Entity* e1, Entity* e2)
+	{
+		ContactKey key = createKey(e1, e2);
+		auto it = contacts.find(key);
+		if (it != contacts.end()) {
+			it->second.touched = true;
+			return;
+		}
+		contacts[key] = { e1, e2, true, true, false };
+	}
+
+	void ContactManager::addTriggerContact(Entity* trigger, Entity* body)
+	{
+		ContactKey key = createKey(trigger, body);
+		auto it = contacts.find(key);
+		if (it != contacts.end()) {
+			it->second.touched = true;
+			return;
+		}
+		contacts[key] = { trigger, body, true, true, true };
+	}
+
+	void ContactManager::endStep(const GameData* data)
+	{
+		events.clear();
+
+		auto it = contacts.begin();
+		while (it != contacts.end()) {
+			Contact& contact = it->second;
+			Entity* a = contact.entityA;
+			Entity* b = contact.entityB;
+
+			// Nothing changes between two sleeping bodies and sleeping bodies
+			// stay inside triggers
+			bool sleepingA = a->getEntityProperties().isSleeping();
+			bool sleepingB = b->getEntityProperties().isSleeping();
+			if ((sleepingA || contact.trigger) && sleepingB) {
+				contact.touched = true;
+			}
+
+			ContactEventType type = ContactEventType::STAY;
+			if (contact.isNew) {
+				type = ContactEventType::BEGIN;
+			} else if (!contact.touched) {
+				type = ContactEventType::END;
+			}
+			events.push_back({ type, a, b, contact.trigger });
+
+			if (type == ContactEventType::END) {
+				it = contacts.erase(it);
+				continue;
+			}
+
+			contact.touched = false;
+			contact.isNew = false;
+			++it;
+		}
+
+		// The pair cache is unordered, sort so the events and callbacks come
+		// in the same order every run
+		std::sort(events.begin(), events.end(), &ContactManager::orderEvents);
+
+		// Callbacks may remove entities and thereby events, dispatch from a
+		// copy and skip the events of entities removed on the way, they may
+		// already be deleted
+		dispatchEvents = events;
+		dispatching = true;
+		for (auto& event : dispatchEvents) {
+			Entity* a = event.entityA;
+			Entity* b = event.entityB;
+			if (event.type == ContactEventType::STAY ||
+			    isRemovedDuringDispatch(a) || isRemovedDuringDispatch(b)) {
+				continue;
+			}
+
+			bool begin = event.type == ContactEventType::BEGIN;
+			if (a->isContactListener()) {
+				if (begin) {
+					a->onContactBegin(b, data);
+				} else {
+					a->onContactEnd(b, data);
+				}
+			}
+			if (isRemovedDuringDispatch(a) || isRemovedDuringDispatch(b)) {
+				continue;
+			}
+			if (b->isContactListener()) {
+				if (begin) {
+					b->onContactBegin(a, data);
+				} else {
+					b->onContactEnd(a, data);
+				}
+			}
+		}
+		dispatching = false;
+		removedDuringDispatch.clear();
+	}
+
+	void ContactManager::removeEntity(const Entity* entity,
+	                                  const GameData* data)
+	{
+		if (dispatching) {
+			removedDuringDispatch.push_back(entity);
+		}
+
+		auto it = contacts.begin();
+		while (it != contacts.end()) {
+			Entity* a = it->second.entityA;
+			Entity* b = it->second.entityB;
+			if (*a != *entity && *b != *entity) {
+				++it;
+				continue;
+			}
+
+			Entity* removed = *a == *entity ? a : b;
+			Entity* partner = removed == a ? b : a;
+			if (partner->isContactListener()) {
+				partner->onContactEnd(removed, data);
+			}
+			it = contacts.erase(it);
+		}
+
+		events.erase(std::remove_if(events.begin(),
+		                            events.end(),
+		                            [entity](const ContactEvent& e) {
+			                            return *e.entityA == *entity ||
+			                                   *e.entityB == *entity;
+		                            }),
+		             events.end());
+	}
+
+	void ContactManager::clear()
+	{
+		contacts.clear();
+		events.clear();
+	}
+
+	const std::vector<ContactEvent>& ContactManager::getEvents() const
+	{
+		return events;
+	}
+
+	size_t ContactManager::getContactCount() const { return contacts.size(); }
+} // namespace flat2d
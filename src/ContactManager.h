@@ -0,0 +1,158 @@
+#ifndef CONTACTMANAGER_H_
+#define CONTACTMANAGER_H_
+
+#include <SDL.h>
+#include <unordered_map>
+#include <vector>
+
+#include "EntityKey.h"
+
+namespace flat2d {
+	class Entity;
+	class GameData;
+
+	/**
+	 * The type of a ContactEvent
+	 */
+	enum class ContactEventType
+	{
+		BEGIN,
+		STAY,
+		END
+	};
+
+	/**
+	 * A change (or lack of change) in the contact between two Entity objects
+	 * during the last physics step. For trigger contacts entityA is the
+	 * trigger and entityB the body that entered it.
+	 */
+	struct ContactEvent
+	{
+		ContactEventType type;
+		Entity* entityA;
+		Entity* entityB;
+		bool trigger;
+	};
+
+	/**
+	 * Keeps track of touching Entity pairs across frames. The
+	 * CollisionDetector reports every collision to the ContactManager and
+	 * after the physics step the EntityContainer ends the step which turns
+	 * the reports into a batch of begin, stay and end events. Entity objects
+	 * marked as contact listeners get onContactBegin and onContactEnd
+	 * callbacks but no calls for contacts that persist.
+	 * It's owned by the EntityContainer, game code should only read events.
+	 */
+	class ContactManager
+	{
+	  private:
+		struct Contact
+		{
+			Entity* entityA;
+			Entity* entityB;
+			bool touched;
+			bool isNew;
+			bool trigger;
+		};
+
+		/**
+		 * The keys of a touching pair, the lower key first so both
+		 * orders of the pair find the same Contact
+		 */
+		struct ContactKey
+		{
+			EntityKey first;
+			EntityKey second;
+
+			bool operator==(const ContactKey& o) const
+			{
+				return first == o.first && second == o.second;
+			}
+
+			bool operator<(const ContactKey& o) const
+			{
+				return first < o.first ||
+				       (first == o.first && second < o.second);
+			}
+		};
+
+		struct ContactKeyHash
+		{
+			size_t operator()(const ContactKey& key) const
+			{
+				std::hash<EntityKey> hasher;
+				size_t h = hasher(key.first);
+				return h ^ (hasher(key.second) + 0x9E3779B9 + (h << 6) +
+				            (h >> 2));
+			}
+		};
+
+		typedef std::unordered_map<ContactKey, Contact, ContactKeyHash>
+		  ContactMap;
+
+		ContactMap contacts;
+		std::vector<ContactEvent> events;
+		std::vector<ContactEvent> dispatchEvents;
+		std::vector<const Entity*> removedDuringDispatch;
+		bool dispatching = false;
+
+		static ContactKey createKey(const Entity* e1, const Entity* e2);
+		static bool orderEvents(const ContactEvent& e1, const ContactEvent& e2);
+		bool isRemovedDuringDispatch(const Entity* entity) const;
+
+	  public:
+		/**
+		 * Report that two Entity objects touched during this step. Used by
+		 * the CollisionDetector, avoid using in game code.
+		 * @param e1 The first Entity
+		 * @param e2 The second Entity
+		 */
+		void addContact(Entity* e1, Entity* e2);
+
+		/**
+		 * Report that a body overlapped a trigger during this step. Used by
+		 * the EntityContainer, avoid using in game code. The contact is kept
+		 * while the body sleeps.
+		 * @param trigger The trigger Entity
+		 * @param body The overlapping Entity
+		 */
+		void addTriggerContact(Entity* trigger, Entity* body);
+
+		/**
+		 * End the physics step. Builds the event batch, ordered on the ids of
+		 * the entities, and calls the contact listener callbacks. Called by
+		 * the EntityContainer after moving the objects.
+		 * @param data The GameData object
+		 */
+		void endStep(const GameData* data);
+
+		/**
+		 * Drop all contacts involving an Entity that is being removed. The
+		 * partner of each contact gets its onContactEnd callback right away
+		 * and events referencing the Entity are removed from the batch.
+		 * @param entity The removed Entity
+		 * @param data The GameData object, nullptr if the Entity was
+		 * unregistered outside the game loop
+		 */
+		void removeEntity(const Entity* entity, const GameData* data);
+
+		/**
+		 * Drop all contacts and events without any callbacks
+		 */
+		void clear();
+
+		/**
+		 * Get the events from the last physics step
+		 * @return The events
+		 */
+		const std::vector<ContactEvent>& getEvents() const;
+
+		/**
+		 * Get the number of touching pairs
+		 * @return The number of contacts
+		 */
+		size_t getContactCount() const;
+	};
+} // namespace flat2d
+
+#endif // CONTACTMANAGER_H_
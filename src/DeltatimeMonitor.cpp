@@ -4,8 +4,14 @@
 namespace flat2d {
 	void DeltatimeMonitor::updateDeltaTime()
 	{
-		if (currentTime == 0) {
+		if (fixedTicksPerSecond != 0) {
+			tickCount++;
+			return;
+		}
+
+		if (!started) {
 			currentTime = SDL_GetTicks();
+			started = true;
 			return;
 		}
 
@@ -15,4 +21,65 @@ namespace flat2d {
 	}
 
 	float DeltatimeMonitor::getDeltaTime() const { return deltaTime; }
+
+	void DeltatimeMonitor::injectDeltaTime(float deltatime)
+	{
+		deltaTime = deltatime;
+	}
+
+	void DeltatimeMonitor::setFixedTimestep(unsigned int ticksPerSecond)
+	{
+		fixedTicksPerSecond = ticksPerSecond;
+		tickCount = 0;
+		started = false;
+		accumulator = 0;
+		if (ticksPerSecond != 0) {
+			deltaTime = 1.0f / ticksPerSecond;
+		}
+	}
+
+	unsigned int DeltatimeMonitor::collectTicks()
+	{
+		return collectTicks(SDL_GetTicks());
+	}
+
+	unsigned int DeltatimeMonitor::collectTicks(Uint32 now)
+	{
+		if (fixedTicksPerSecond == 0) {
+			return 1;
+		}
+
+		// The first frame runs a single tick
+		if (!started) {
+			currentTime = now;
+			started = true;
+			return 1;
+		}
+
+		// Integer time so no rounding error builds up, Uint32 subtraction
+		// handles the wrap around
+		accumulator += static_cast<Uint64>(now - currentTime) *
+		               fixedTicksPerSecond;
+		currentTime = now;
+		Uint64 ticks = accumulator / 1000;
+		if (ticks > maxTicksPerFrame) {
+			ticks = maxTicksPerFrame;
+			accumulator = 0;
+		} else {
+			accumulator -= ticks * 1000;
+		}
+		return static_cast<unsigned int>(ticks);
+	}
+
+	void DeltatimeMonitor::setMaxTicksPerFrame(unsigned int ticks)
+	{
+		maxTicksPerFrame = ticks > 0 ? ticks : 1;
+	}
+
+	bool DeltatimeMonitor::isFixedTimestep() const
+	{
+		return fixedTicksPerSecond != 0;
+	}
+
+	unsigned int DeltatimeMonitor::getTickCount() const { return tickCount; }
 } // namespace flat2d
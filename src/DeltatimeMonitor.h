@@ -1,6 +1,8 @@
 #ifndef DELTATIMEMONITOR_H_
 #define DELTATIMEMONITOR_H_
 
+#include <SDL.h>
+
 namespace flat2d {
 	/**
 	 * The DeltatimeMonitor keeps track of deltatimes during engine loops
@@ -10,8 +12,13 @@ namespace flat2d {
 	{
 	  private:
 		float deltaTime = 1.0;
-		int currentTime = 0;
-		int oldTime = 0;
+		Uint32 currentTime = 0;
+		Uint32 oldTime = 0;
+		bool started = false;
+		unsigned int fixedTicksPerSecond = 0;
+		unsigned int tickCount = 0;
+		unsigned int maxTicksPerFrame = 5;
+		Uint64 accumulator = 0; // Milliseconds times ticks per second
 
 	  public:
 		/**
@@ -25,6 +32,66 @@ namespace flat2d {
 		 * your objects during update steps.
 		 */
 		float getDeltaTime() const;
+
+		/**
+		 * Override the deltatime of the current frame. Used by the
+		 * InputRecorder to replay recorded deltatimes.
+		 * @param deltatime The deltatime to use
+		 */
+		void injectDeltaTime(float deltatime);
+
+		/**
+		 * Use a fixed timestep instead of the wall clock. Every update then
+		 * advances the game by exactly one tick which makes the simulation
+		 * deterministic, useful for replays, lockstep and rollback
+		 * networking. The GameEngine runs as many ticks per rendered frame
+		 * as the wall clock time requires (see collectTicks) so the game
+		 * speed doesn't depend on the frame rate. In this mode the
+		 * EntityContainer also hashes the Entity state after each tick.
+		 * Set to 0 to return to wall clock deltatimes.
+		 * @param ticksPerSecond The number of ticks per game second
+		 */
+		void setFixedTimestep(unsigned int ticksPerSecond);
+
+		/**
+		 * Collect the wall clock time passed since the last call and get
+		 * the number of fixed ticks it amounts to. The remainder is kept
+		 * for the next frame. Used by the GameEngine, avoid calling it
+		 * from game code.
+		 * @return The number of ticks to run, always 1 without a fixed
+		 * timestep
+		 */
+		unsigned int collectTicks();
+
+		/**
+		 * Collect the ticks up to a given time instead of the wall clock.
+		 * Lets tests and custom clocks drive the fixed timestep.
+		 * @param now The current time in milliseconds
+		 * @return The number of ticks to run, always 1 without a fixed
+		 * timestep
+		 */
+		unsigned int collectTicks(Uint32 now);
+
+		/**
+		 * Set the max number of fixed ticks run per frame. Time beyond it
+		 * is dropped, slowing the game down instead of falling further
+		 * behind when ticks take longer than the time they simulate.
+		 * Defaults to 5.
+		 * @param ticks The max ticks per frame
+		 */
+		void setMaxTicksPerFrame(unsigned int ticks);
+
+		/**
+		 * Check if a fixed timestep is used
+		 * @return true or false
+		 */
+		bool isFixedTimestep() const;
+
+		/**
+		 * Get the number of fixed timestep ticks taken
+		 * @return The tick count
+		 */
+		unsigned int getTickCount() const;
 	};
 } // namespace flat2d
 
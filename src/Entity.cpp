@@ -8,7 +8,14 @@
 #include <string>
 
 namespace flat2d {
-	void Entity::setDead(bool dead) { this->dead = dead; }
+	void Entity::setDead(bool dead)
+	{
+		this->dead = dead;
+		if (dead && killQueue != nullptr && !killQueued) {
+			killQueued = true;
+			killQueue->push_back(this);
+		}
+	}
 
 	bool Entity::isDead() const { return dead; }
 
@@ -20,20 +27,16 @@ namespace flat2d {
 
 		SDL_Rect bounding_box = entityProperties.getBoundingBox();
 		if (data->getCamera() != nullptr && !fixedPosition) {
-			int z = entityProperties.getDepth();
-			Camera* camera = data->getCamera();
-
-			if (!camera->isVisibleOnCamera(bounding_box, z)) {
+			data->transformToScreen(
+			  &bounding_box, 1, entityProperties.getDepth());
+			if (!data->getCamera()->isVisibleOnScreen(bounding_box)) {
 				return;
 			}
-
-			bounding_box.x = camera->getScreenXposFor(bounding_box.x, z);
-			bounding_box.y = camera->getScreenYposFor(bounding_box.y, z);
 		}
 
 		const SDL_Rect* renderClip = nullptr;
-		if (!currentAnimation.empty()) {
-			renderClip = animations.at(currentAnimation)->run();
+		if (currentAnimation != nullptr) {
+			renderClip = currentAnimation->run();
 		} else {
 			renderClip = &clip;
 		}
@@ -109,28 +112,108 @@ namespace flat2d {
 		this->inputHandler = inputHandler;
 	}
 
+	void Entity::subscribeEvent(Uint32 type)
+	{
+		for (auto subscription : eventSubscriptions) {
+			if (subscription == type) {
+				return;
+			}
+		}
+		eventSubscriptions.push_back(type);
+	}
+
+	const std::vector<Uint32>& Entity::getEventSubscriptions() const
+	{
+		return eventSubscriptions;
+	}
+
+	void Entity::setEventRegion(const SDL_Rect& region)
+	{
+		eventRegion = region;
+	}
+
+	bool Entity::acceptsEvent(const SDL_Event& event) const
+	{
+		if (eventRegion.w == 0 || eventRegion.h == 0) {
+			return true;
+		}
+
+		int x, y;
+		switch (event.type) {
+			case SDL_MOUSEMOTION:
+				x = event.motion.x;
+				y = event.motion.y;
+				break;
+			case SDL_MOUSEBUTTONDOWN:
+			case SDL_MOUSEBUTTONUP:
+				x = event.button.x;
+				y = event.button.y;
+				break;
+			default:
+				return true;
+		}
+
+		return x >= eventRegion.x && x < eventRegion.x + eventRegion.w &&
+		       y >= eventRegion.y && y < eventRegion.y + eventRegion.h;
+	}
+
+	bool Entity::isContactListener() const { return contactListener; }
+
+	void Entity::setContactListener(bool contactListener)
+	{
+		this->contactListener = contactListener;
+	}
+
 	void Entity::addAnimation(std::string id, Animation* animation)
 	{
-		assert(animations.find(id) == animations.end());
+		addAnimation(Animation::intern(id), animation);
+	}
+
+	void Entity::addAnimation(AnimationId id, Animation* animation)
+	{
+		for (auto& it : animations) {
+			assert(it.first != id);
+		}
 
-		animations[id] = animation;
+		animations.push_back(std::make_pair(id, animation));
 	}
 
 	void Entity::startAnimation(std::string id)
 	{
-		assert(animations.find(id) != animations.end());
+		startAnimation(Animation::intern(id));
+	}
+
+	Animation* Entity::getAnimation(AnimationId id) const
+	{
+		// Entities have few animations, a scan beats a map lookup
+		for (auto& it : animations) {
+			if (it.first == id) {
+				return it.second;
+			}
+		}
+		return nullptr;
+	}
+
+	Animation* Entity::getCurrentAnimation() const { return currentAnimation; }
 
-		if (!currentAnimation.empty()) {
-			animations[currentAnimation]->stop();
+	void Entity::startAnimation(AnimationId id)
+	{
+		Animation* animation = getAnimation(id);
+		assert(animation != nullptr);
+
+		if (currentAnimation != nullptr) {
+			currentAnimation->stop();
 		}
-		currentAnimation = id;
-		animations[currentAnimation]->start();
+		currentAnimation = animation;
+		currentAnimation->start();
 	}
 
 	void Entity::stopAnimations()
 	{
-		animations[currentAnimation]->stop();
-		currentAnimation = "";
+		if (currentAnimation != nullptr) {
+			currentAnimation->stop();
+		}
+		currentAnimation = nullptr;
 	}
 
 	EntityProperties& Entity::getEntityProperties() { return entityProperties; }
@@ -2,12 +2,15 @@
 #define ENTITY_H_
 
 #include <SDL.h>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "Animation.h"
+#include "EntityKey.h"
 #include "EntityProperties.h"
 #include "UID.h"
 
@@ -15,8 +18,23 @@ namespace flat2d {
 	class Camera;
 	class RenderData;
 	class GameData;
+	class Snapshot;
 	class Texture;
 
+	/**
+	 * The Entity callbacks the EntityContainer can skip for types that
+	 * don't override them, see EntityContainer::registerType
+	 */
+	enum EntityHook
+	{
+		HOOK_PRE_MOVE = 0x1,
+		HOOK_POST_MOVE = 0x2,
+		HOOK_PRE_RENDER = 0x4,
+		HOOK_POST_RENDER = 0x8,
+		HOOK_ALL = 0xF,
+		HOOK_BATCH_MOVE = 0x10
+	};
+
 	/**
 	 * The Entity class. You can extend this to create your game objects.
 	 * Extend it publicly. To integrate your custom functionality use the
@@ -30,17 +48,30 @@ namespace flat2d {
 	{
 	  private:
 		size_t id;
+		mutable std::string stringId;
 		bool fixedPosition = false;
 		bool inputHandler = false;
+		bool contactListener = false;
 		SDL_Rect clip;
+		SDL_Rect eventRegion = { 0, 0, 0, 0 };
+		std::vector<Uint32> eventSubscriptions;
 		std::shared_ptr<Texture> texture = nullptr;
+		Uint32 hooks = HOOK_ALL;
+		std::vector<Entity*>* hookGroup = nullptr;
+		std::vector<Entity*>* killQueue = nullptr;
+		bool killQueued = false;
+		int layer = -1;
+		bool asyncInit = false;
+		std::atomic<int> initStage{ 0 };
+		size_t initJob = 0;
+		Animation* currentAnimation = nullptr;
+		std::vector<std::pair<AnimationId, Animation*>> animations;
+
+		friend class EntityContainer;
 
 	  protected:
 		EntityProperties entityProperties;
 
-		std::string currentAnimation = "";
-		std::map<std::string, Animation*> animations;
-
 		bool dead = false;
 
 	  public:
@@ -61,8 +92,8 @@ namespace flat2d {
 
 		virtual ~Entity()
 		{
-			for (auto it = animations.begin(); it != animations.end(); it++) {
-				delete it->second;
+			for (auto& it : animations) {
+				delete it.second;
 			}
 		}
 
@@ -75,6 +106,7 @@ namespace flat2d {
 		{
 			// TODO(Linus): This doesn't look right...
 			id = o.id;
+			stringId.clear();
 			return *this;
 		}
 
@@ -85,16 +117,22 @@ namespace flat2d {
 		virtual int getId() const { return static_cast<int>(id); }
 
 		/**
-		 * Get the id as a string
+		 * Get the key identifying the Entity in containers
+		 * @return The EntityKey
+		 */
+		EntityKey getKey() const { return EntityKey(id); }
+
+		/**
+		 * Get the id as a string. Meant for debugging, containers use
+		 * getKey. The string is created on the first call.
 		 * @return id as a string
 		 */
 		virtual std::string getStringId() const
 		{
-			std::string number;
-			std::stringstream ss;
-			ss << id;
-			ss >> number;
-			return number;
+			if (stringId.empty()) {
+				stringId = std::to_string(id);
+			}
+			return stringId;
 		}
 
 		virtual bool operator<(const Entity& o) const { return id < o.id; }
@@ -115,7 +153,10 @@ namespace flat2d {
 		void setClip(const SDL_Rect&);
 
 		/**
-		 * Mark the Entity as dead.
+		 * Mark the Entity as dead. A registered Entity is queued for removal
+		 * and deleted by the EntityContainer after the next move. Setting
+		 * the dead member directly doesn't queue the Entity, see
+		 * EntityContainer::setDeadObjectScan.
 		 */
 		void setDead(bool isDead);
 
@@ -146,6 +187,52 @@ namespace flat2d {
 		 */
 		void setInputHandler(bool inputHandler);
 
+		/**
+		 * Subscribe this Entity to an SDL event type. Subscribed Entity
+		 * objects only get handle calls for the event types they subscribe
+		 * to, without the preHandle and postHandle calls. Entity objects
+		 * without subscriptions that are input handlers get every event.
+		 * Subscribe before registering the Entity to the EntityContainer.
+		 * @param type The SDL event type (SDL_KEYDOWN, SDL_MOUSEMOTION etc)
+		 */
+		void subscribeEvent(Uint32 type);
+
+		/**
+		 * Get the event types this Entity subscribes to
+		 * @return The subscribed event types
+		 */
+		const std::vector<Uint32>& getEventSubscriptions() const;
+
+		/**
+		 * Limit the subscribed mouse motion and button events to a region
+		 * of the screen. An empty region (the default) accepts events
+		 * everywhere.
+		 * @param region The region in screen coordinates
+		 */
+		void setEventRegion(const SDL_Rect& region);
+
+		/**
+		 * Check if a subscribed event should be delivered to this Entity
+		 * @param event The event
+		 * @return true or false
+		 */
+		bool acceptsEvent(const SDL_Event& event) const;
+
+		/**
+		 * Check if this Entity listens for contact begin and end
+		 * @return true or false
+		 */
+		bool isContactListener() const;
+
+		/**
+		 * Mark this Entity as a contact listener. Contact listeners get the
+		 * onContactBegin and onContactEnd callbacks once when a contact
+		 * starts and ends, in addition to the onCollision callbacks that
+		 * still come every frame the Entities collide.
+		 * @param contactListener true or false
+		 */
+		void setContactListener(bool contactListener);
+
 		/**
 		 * Add an Animation to this Entity. Animations will
 		 * override clip set through setClip. Animations that are added
@@ -156,6 +243,14 @@ namespace flat2d {
 		 */
 		void addAnimation(std::string id, Animation* animation);
 
+		/**
+		 * Add an Animation to this Entity using an id from
+		 * Animation::intern
+		 * @param id The interned animation id
+		 * @param animation The animation
+		 */
+		void addAnimation(AnimationId id, Animation* animation);
+
 		/**
 		 * Start an animation that was previously added
 		 * This will override the clip setting as long as the animation
@@ -164,11 +259,31 @@ namespace flat2d {
 		 */
 		void startAnimation(std::string id);
 
+		/**
+		 * Start an animation that was previously added using an id from
+		 * Animation::intern. Avoids the string handling of the name.
+		 * @param id The interned animation id
+		 */
+		void startAnimation(AnimationId id);
+
 		/**
 		 * Stop an animation and return to rendering the clip if one is set
 		 */
 		void stopAnimations();
 
+		/**
+		 * Get a previously added animation
+		 * @param id The interned animation id
+		 * @return The Animation or nullptr if there is none with the id
+		 */
+		Animation* getAnimation(AnimationId id) const;
+
+		/**
+		 * Get the running animation
+		 * @return The Animation or nullptr if no animation is running
+		 */
+		Animation* getCurrentAnimation() const;
+
 		/**
 		 * Return the EntityProperties object.
 		 * @return A reference to the EntityProperties
@@ -200,7 +315,8 @@ namespace flat2d {
 
 		/**
 		 * Check if the Entity is dead. When this returns true the
-		 * EntityContainer will destroy the object next cycle.
+		 * EntityContainer will destroy the object next cycle. Overrides are
+		 * only checked with EntityContainer::setDeadObjectScan enabled.
 		 * @return true or false
 		 */
 		virtual bool isDead() const;
@@ -239,12 +355,69 @@ namespace flat2d {
 		 */
 		virtual bool onHorizontalCollision(Entity* collider, const GameData*);
 
+		/**
+		 * Callback that is called after the physics step when the Entity
+		 * starts touching another Entity. Only called on contact listeners.
+		 * @param other The other Entity
+		 * @param data The GameData object pointer
+		 */
+		virtual void onContactBegin(Entity* other, const GameData* data) {}
+
+		/**
+		 * Callback that is called after the physics step when the Entity
+		 * stops touching another Entity, or right away when the other Entity
+		 * is removed. Only called on contact listeners.
+		 * @param other The other Entity
+		 * @param data The GameData object pointer, may be nullptr if the
+		 * other Entity was unregistered outside the game loop
+		 */
+		virtual void onContactEnd(Entity* other, const GameData* data) {}
+
+		/**
+		 * Write custom state into a Snapshot taken by the EntityContainer.
+		 * Override this to include your own game state in snapshots. The
+		 * EntityProperties are saved by the EntityContainer.
+		 * @param snapshot The Snapshot to write to
+		 */
+		virtual void writeState(Snapshot* snapshot) const {}
+
+		/**
+		 * Read custom state back when the EntityContainer restores a
+		 * Snapshot. Read the values in the order writeState wrote them.
+		 * @param snapshot The Snapshot to read from
+		 */
+		virtual void readState(Snapshot* snapshot) {}
+
 		/**
 		 * An init method. Can be used to load resources into Entity
 		 * @param gameData The GameData
 		 */
 		virtual void init(const GameData* gameData) {}
 
+		/**
+		 * The part of init that can run off the main thread, like reading
+		 * and decoding files. Only called if asynchronous init is enabled.
+		 * It runs on the JobPool of the EntityContainer, before init is
+		 * called on the main thread, so it mustn't use the renderer, the
+		 * Mixer or the EntityContainer.
+		 * @param gameData The GameData
+		 */
+		virtual void initAsync(const GameData* gameData) {}
+
+		/**
+		 * Have initAsync called on a worker thread before init. The
+		 * Entity isn't moved or rendered until both have run. Set it
+		 * before the Entity is registered.
+		 * @param async true or false
+		 */
+		void setAsyncInit(bool async) { asyncInit = async; }
+
+		/**
+		 * Check if the Entity is initiated asynchronously
+		 * @return true or false
+		 */
+		bool hasAsyncInit() const { return asyncInit; }
+
 		/**
 		 * Callback that is triggered before handle is triggered
 		 * @param gameData The GameData
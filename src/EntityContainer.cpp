@@ -1,21 +1,148 @@
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <functional>
+#include <limits>
 #include <map>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "Camera.h"
 #include "CollisionDetector.h"
+#include "ComponentRegistry.h"
 #include "DeltatimeMonitor.h"
 #include "Entity.h"
 #include "EntityContainer.h"
 #include "EntityProperties.h"
 #include "GameData.h"
+#include "JobPool.h"
 #include "RenderData.h"
 #include "RuntimeAnalyzer.h"
+#include "Snapshot.h"
+#include "UID.h"
 
 namespace flat2d {
-	EntityContainer::~EntityContainer() { unregisterAllObjects(); }
+	static const Uint32 STATE_COLLIDABLE = 1 << 0;
+	static const Uint32 STATE_STATIC = 1 << 1;
+	static const Uint32 STATE_CONTINUOUS = 1 << 2;
+	static const Uint32 STATE_TRIGGER = 1 << 3;
+	static const Uint32 STATE_VISIBLE = 1 << 4;
+	static const Uint32 STATE_SLEEPING = 1 << 5;
+	static const Uint32 STATE_DEAD = 1 << 6;
+
+	static const int INIT_PENDING = 0;
+	static const int INIT_RUNNING = 1;
+	static const int INIT_LOADED = 2;
+
+	/**
+	 * The saved EntityProperties of an Entity. The 64 bit key comes first
+	 * and is followed by an even number of 32 bit fields so there is no
+	 * padding and equal states have equal bytes.
+	 */
+	struct EntityContainer::EntityState
+	{
+		Uint64 key;
+		Sint32 x, y, w, h, z;
+		float xvel, yvel;
+		EntityShape collider;
+		Uint32 category;
+		Uint32 mask;
+		Uint32 idleFrames;
+		Uint32 flags;
+		Uint32 customSize;
+	};
+
+	static bool shapesOverlap(const EntityShape& b1, const EntityShape& b2)
+	{
+		return !(b1.x > b2.x + b2.w) && !(b1.x + b1.w < b2.x) &&
+		       !(b1.y > b2.y + b2.h) && !(b1.y + b1.h < b2.y);
+	}
+
+	static float distanceToShape(int x, int y, const EntityShape& shape)
+	{
+		int dx = std::max(std::max(shape.x - x, 0), x - (shape.x + shape.w));
+		int dy = std::max(std::max(shape.y - y, 0), y - (shape.y + shape.h));
+		return std::sqrt(static_cast<float>(dx * dx + dy * dy));
+	}
+
+	static float distanceToEntity(int x, int y, const Entity* entity)
+	{
+		return distanceToShape(
+		  x, y, entity->getEntityProperties().getColliderShape());
+	}
+
+	static int partitionIndex(int pos, int dim)
+	{
+		return pos >= 0 ? pos / dim : -((dim - 1 - pos) / dim);
+	}
+
+	static bool intersectRay(float x,
+	                         float y,
+	                         float dx,
+	                         float dy,
+	                         const EntityShape& shape,
+	                         RayHit* hit)
+	{
+		float tmin = 0.0f;
+		float tmax = 1.0f;
+		hit->normalx = 0.0f;
+		hit->normaly = 0.0f;
+
+		// Clip the ray against the x and y slabs of the shape
+		if (dx == 0.0f) {
+			if (x < shape.x || x > shape.x + shape.w) {
+				return false;
+			}
+		} else {
+			float t1 = (shape.x - x) / dx;
+			float t2 = (shape.x + shape.w - x) / dx;
+			float normal = -1.0f;
+			if (t1 > t2) {
+				std::swap(t1, t2);
+				normal = 1.0f;
+			}
+			if (t1 > tmin) {
+				tmin = t1;
+				hit->normalx = normal;
+			}
+			tmax = std::min(tmax, t2);
+		}
+
+		if (dy == 0.0f) {
+			if (y < shape.y || y > shape.y + shape.h) {
+				return false;
+			}
+		} else {
+			float t1 = (shape.y - y) / dy;
+			float t2 = (shape.y + shape.h - y) / dy;
+			float normal = -1.0f;
+			if (t1 > t2) {
+				std::swap(t1, t2);
+				normal = 1.0f;
+			}
+			if (t1 > tmin) {
+				tmin = t1;
+				hit->normalx = 0.0f;
+				hit->normaly = normal;
+			}
+			tmax = std::min(tmax, t2);
+		}
+
+		if (tmin > tmax) {
+			return false;
+		}
+
+		hit->distance = tmin;
+		return true;
+	}
+
+	EntityContainer::~EntityContainer()
+	{
+		unregisterAllObjects();
+		clearLayerCaches();
+	}
 
 	void EntityContainer::addLayer(unsigned int layer)
 	{
@@ -36,10 +163,80 @@ namespace flat2d {
 		return keys;
 	}
 
+	void EntityContainer::setLayerCached(Layer layer, bool cached)
+	{
+		auto it = layerCaches.find(layer);
+		if (cached && it == layerCaches.end()) {
+			layerCaches[layer] = LayerCache();
+		} else if (!cached && it != layerCaches.end()) {
+			if (it->second.texture != nullptr) {
+				SDL_DestroyTexture(it->second.texture);
+			}
+			layerCaches.erase(it);
+		}
+	}
+
+	bool EntityContainer::isLayerCached(Layer layer) const
+	{
+		return layerCaches.find(layer) != layerCaches.end();
+	}
+
+	void EntityContainer::invalidateLayer(Layer layer)
+	{
+		auto it = layerCaches.find(layer);
+		if (it != layerCaches.end()) {
+			it->second.dirty = true;
+		}
+	}
+
+	void EntityContainer::invalidateLayerOf(const Entity* entity)
+	{
+		EntityKey objId = entity->getKey();
+		for (auto& it : layerCaches) {
+			const ObjectList& list = layeredObjects[it.first];
+			if (list.find(objId) != list.end()) {
+				it.second.dirty = true;
+			}
+		}
+	}
+
+	void EntityContainer::clearLayerCaches()
+	{
+		for (auto& it : layerCaches) {
+			if (it.second.texture != nullptr) {
+				SDL_DestroyTexture(it.second.texture);
+			}
+		}
+		layerCaches.clear();
+	}
+
+	template<typename Func>
+	void EntityContainer::forEachPartitionOf(const EntityProperties& props,
+	                                         Func func) const
+	{
+		EntityShape boundingBox = createBoundingBoxFor(props);
+		int xmax = boundingBox.x + boundingBox.w;
+		int ymax = boundingBox.y + boundingBox.h;
+		int step = static_cast<int>(spatialPartitionDimension);
+
+		// Visit every partition the bounding box covers, the last step
+		// may revisit a partition
+		for (int i = boundingBox.x;; i = std::min(i + step, xmax)) {
+			for (int j = boundingBox.y;; j = std::min(j + step, ymax)) {
+				func(MapArea::partitionFor(i, j, spatialPartitionDimension));
+				if (j >= ymax) {
+					break;
+				}
+			}
+			if (i >= xmax) {
+				break;
+			}
+		}
+	}
+
 	void EntityContainer::registerObject(Entity* object, Layer layer)
 	{
-		std::string objId = object->getStringId();
-		if (objects.find(objId) != objects.end()) {
+		if (objects.find(object->getKey()) != objects.end()) {
 			return;
 		}
 
@@ -48,24 +245,141 @@ namespace flat2d {
 			return;
 		}
 
-		objects[objId] = object;
-		uninitiatedEntities[objId] = object;
-		layeredObjects[layer][objId] = object;
-		registerObjectToSpatialPartitions(object);
-		if (object->isInputHandler()) {
-			inputHandlers[objId] = object;
+		addObject(object, layer, nullptr);
+		invalidateLayer(layer);
+	}
+
+	void EntityContainer::registerObjects(Entity* const* entities,
+	                                      size_t count,
+	                                      Layer layer)
+	{
+		auto layerIt = layeredObjects.find(layer);
+		if (layerIt == layeredObjects.end() || count == 0) {
+			return;
+		}
+
+		// New Entities have the highest ids, in id order every insert
+		// lands at the end of the maps
+		std::vector<Entity*> sorted(entities, entities + count);
+		std::sort(sorted.begin(), sorted.end(), [](Entity* a, Entity* b) {
+			return a->getKey() < b->getKey();
+		});
+
+		PartitionCells cells;
+		cells.reserve(count);
+		for (size_t i = 0; i < sorted.size(); i++) {
+			Entity* object = sorted[i];
+			if ((i > 0 && sorted[i - 1] == object) ||
+			    objects.find(object->getKey()) != objects.end()) {
+				continue;
+			}
+			addObject(object, layer, &cells);
 		}
-		if (object->getEntityProperties().isCollidable()) {
-			collidableObjects[objId] = object;
+
+		// Fill each partition in one go, in id order
+		std::sort(cells.begin(),
+		          cells.end(),
+		          [](const PartitionCell& a, const PartitionCell& b) {
+			          if (a.first != b.first) {
+				          return a.first < b.first;
+			          }
+			          return a.second->getKey() < b.second->getKey();
+		          });
+		ObjectList* partition = nullptr;
+		for (size_t i = 0; i < cells.size(); i++) {
+			const PartitionCell& cell = cells[i];
+			if (i > 0 && cells[i - 1] == cell) {
+				continue;
+			}
+			if (i == 0 || cells[i - 1].first != cell.first) {
+				partition = &spatialPartitionMap[cell.first];
+			}
+			partition->emplace_hint(
+			  partition->end(), cell.second->getKey(), cell.second);
+			cell.second->getEntityProperties().getCurrentAreas().push_back(
+			  cell.first);
+		}
+
+		invalidateLayer(layer);
+	}
+
+	void EntityContainer::addObject(Entity* object,
+	                                Layer layer,
+	                                PartitionCells* cells)
+	{
+		EntityKey objId = object->getKey();
+		objects.emplace_hint(objects.end(), objId, object);
+		uninitiatedEntities.emplace_hint(
+		  uninitiatedEntities.end(), objId, object);
+		ObjectList& layerList = layeredObjects[layer];
+		layerList.emplace_hint(layerList.end(), objId, object);
+		if (!object->getEventSubscriptions().empty()) {
+			for (auto type : object->getEventSubscriptions()) {
+				eventSubscribers[type][objId] = object;
+			}
+		} else if (object->isInputHandler()) {
+			inputHandlers.emplace_hint(inputHandlers.end(), objId, object);
+		}
+		if (!typeHooks.empty()) {
+			applyTypeHooks(object);
+		}
+		object->layer = layer;
+		object->killQueue = &killQueue;
+		if (object->isDead()) {
+			object->killQueued = true;
+			killQueue.push_back(object);
+		}
+
+		EntityProperties& props = object->getEntityProperties();
+		props.setSleeping(false);
+		props.wake();
+		props.setWakeCallback([this, object]() { activateObject(object); });
+		activeObjects.emplace_hint(activeObjects.end(), objId, object);
+
+		if (props.isTrigger()) {
+			triggerIndex.insert(object);
+			props.setLocationChanged(false);
+			return;
+		}
+
+		if (props.isCollidable()) {
+			collidableObjects.emplace_hint(
+			  collidableObjects.end(), objId, object);
+		}
+		if (props.isCollidable() && props.isStatic()) {
+			staticIndex.insert(object);
+			props.setLocationChanged(false);
+		} else if (cells == nullptr) {
+			registerObjectToSpatialPartitions(object);
+		} else if (props.isCollidable()) {
+			forEachPartitionOf(props, [cells, object](const MapArea& area) {
+				cells->push_back(std::make_pair(area, object));
+			});
+			props.setLocationChanged(false);
 		}
 	}
 
 	void EntityContainer::repopulateCollidables()
 	{
 		collidableObjects.clear();
+		staticIndex.clear();
+		triggerIndex.clear();
 		for (auto& it : objects) {
-			if (it.second->getEntityProperties().isCollidable()) {
-				collidableObjects[it.first] = it.second;
+			EntityProperties& props = it.second->getEntityProperties();
+			if (props.isTrigger()) {
+				clearObjectFromCurrentPartitions(it.second);
+				triggerIndex.insert(it.second);
+				continue;
+			}
+			if (!props.isCollidable()) {
+				continue;
+			}
+			collidableObjects[it.first] = it.second;
+			if (props.isStatic()) {
+				clearObjectFromCurrentPartitions(it.second);
+				staticIndex.insert(it.second);
+			} else if (props.getCurrentAreas().empty()) {
+				registerObjectToSpatialPartitions(it.second);
 			}
 		}
 	}
@@ -88,36 +402,9 @@ namespace flat2d {
 		}
 
 		EntityProperties& props = o->getEntityProperties();
-		EntityShape boundingBox = createBoundingBoxFor(props);
-
-		addObjectToSpatialPartitionFor(o, boundingBox.x, boundingBox.y);
-		addObjectToSpatialPartitionFor(
-		  o, boundingBox.x, boundingBox.y + boundingBox.h);
-		addObjectToSpatialPartitionFor(
-		  o, boundingBox.x + boundingBox.w, boundingBox.y);
-		addObjectToSpatialPartitionFor(
-		  o, boundingBox.x + boundingBox.w, boundingBox.y + boundingBox.h);
-
-		if (boundingBox.w > static_cast<int>(spatialPartitionDimension)) {
-			for (int i = boundingBox.x + spatialPartitionDimension;
-			     i < boundingBox.x + boundingBox.w;
-			     i += spatialPartitionDimension) {
-				addObjectToSpatialPartitionFor(o, i, boundingBox.y);
-				addObjectToSpatialPartitionFor(
-				  o, i, boundingBox.y + boundingBox.h);
-			}
-		}
-
-		if (boundingBox.h > static_cast<int>(spatialPartitionDimension)) {
-			for (int i = boundingBox.y + spatialPartitionDimension;
-			     i < boundingBox.h + boundingBox.h;
-			     i += spatialPartitionDimension) {
-				addObjectToSpatialPartitionFor(o, boundingBox.x, i);
-				addObjectToSpatialPartitionFor(
-				  o, boundingBox.x + boundingBox.w, i);
-			}
-		}
-
+		forEachPartitionOf(props, [this, o](const MapArea& area) {
+			addObjectToSpatialPartitionFor(o, area);
+		});
 		props.setLocationChanged(false);
 	}
 
@@ -126,7 +413,7 @@ namespace flat2d {
 		EntityProperties::Areas& currentAreas =
 		  o->getEntityProperties().getCurrentAreas();
 		for (auto it = currentAreas.begin(); it != currentAreas.end(); it++) {
-			spatialPartitionMap[*it].erase(o->getStringId());
+			spatialPartitionMap[*it].erase(o->getKey());
 		}
 
 		currentAreas.clear();
@@ -147,7 +434,7 @@ namespace flat2d {
 			    !it->containsPoint(bounder.x + bounder.w, bounder.y) &&
 			    !it->containsPoint(bounder.x + bounder.w,
 			                       bounder.y + bounder.h)) {
-				spatialPartitionMap[*it].erase(o->getStringId());
+				spatialPartitionMap[*it].erase(o->getKey());
 				indexes.push_back(index++);
 			}
 		}
@@ -158,16 +445,11 @@ namespace flat2d {
 	}
 
 	void EntityContainer::addObjectToSpatialPartitionFor(Entity* o,
-	                                                     int x,
-	                                                     int y)
+	                                                     const MapArea& area)
 	{
-		std::string objId = o->getStringId();
-
-		unsigned int xcord = (x - (x % spatialPartitionDimension));
-		unsigned int ycord = (y - (y % spatialPartitionDimension));
+		EntityKey objId = o->getKey();
 
 		// Find and make sure partition exists
-		MapArea area(xcord, ycord, spatialPartitionDimension);
 		if (spatialPartitionMap.find(area) == spatialPartitionMap.end()) {
 			spatialPartitionMap[area] = ObjectList();
 		}
@@ -184,52 +466,291 @@ namespace flat2d {
 		spatialPartitionMap[area][objId] = o;
 	}
 
+	void EntityContainer::removeObjectFromIndexes(Entity* o)
+	{
+		const EntityProperties& props = o->getEntityProperties();
+		if (props.isTrigger()) {
+			triggerIndex.remove(o);
+		} else if (props.isCollidable() && props.isStatic()) {
+			staticIndex.remove(o);
+		}
+	}
+
+	void EntityContainer::handleTriggersFor(Entity* o)
+	{
+		const EntityProperties& props = o->getEntityProperties();
+		EntityShape shape = props.getColliderShape();
+		int xmax = shape.x + shape.w;
+		int ymax = shape.y + shape.h;
+		int step = static_cast<int>(spatialPartitionDimension);
+
+		auto check = [this, o, &props, &shape](Entity* trigger) {
+			const EntityProperties& triggerProps =
+			  trigger->getEntityProperties();
+			if (props.canCollideWith(triggerProps) &&
+			    shapesOverlap(shape, triggerProps.getColliderShape())) {
+				contactManager.addTriggerContact(trigger, o);
+			}
+		};
+
+		for (int i = shape.x;; i = std::min(i + step, xmax)) {
+			for (int j = shape.y;; j = std::min(j + step, ymax)) {
+				triggerIndex.forEachIn(
+				  MapArea::partitionFor(i, j, spatialPartitionDimension),
+				  check);
+				if (j >= ymax) {
+					break;
+				}
+			}
+			if (i >= xmax) {
+				break;
+			}
+		}
+	}
+
+	void EntityContainer::activateObject(Entity* o)
+	{
+		EntityKey objId = o->getKey();
+		sleepingObjects.erase(objId);
+		activeObjects[objId] = o;
+	}
+
+	void EntityContainer::deactivateObject(Entity* o)
+	{
+		EntityKey objId = o->getKey();
+		o->getEntityProperties().setSleeping(true);
+		activeObjects.erase(objId);
+		sleepingObjects[objId] = o;
+	}
+
+	void EntityContainer::wakeScheduledObjects()
+	{
+		auto end = scheduledWakes.upper_bound(simulationTime);
+		for (auto it = scheduledWakes.begin(); it != end; it++) {
+			auto objectIter = objects.find(it->second);
+			if (objectIter != objects.end()) {
+				objectIter->second->getEntityProperties().wake();
+			}
+		}
+		scheduledWakes.erase(scheduledWakes.begin(), end);
+	}
+
+	void EntityContainer::scheduleWake(const Entity* entity, float seconds)
+	{
+		scheduledWakes.insert(
+		  std::make_pair(simulationTime + seconds, entity->getKey()));
+	}
+
+	void EntityContainer::setDeadObjectScan(bool scan)
+	{
+		deadObjectScan = scan;
+	}
+
+	void EntityContainer::setSleepThreshold(unsigned int frames)
+	{
+		sleepThreshold = frames;
+		if (sleepThreshold != 0) {
+			return;
+		}
+
+		// Sleeping disabled, wake everyone
+		for (auto& object : sleepingObjects) {
+			object.second->getEntityProperties().setSleeping(false);
+			activeObjects[object.first] = object.second;
+		}
+		sleepingObjects.clear();
+	}
+
+	size_t EntityContainer::getSleepingCount() const
+	{
+		return sleepingObjects.size();
+	}
+
 	void EntityContainer::setSpatialPartitionDimension(unsigned int i)
 	{
 		spatialPartitionDimension = i;
+		staticIndex.setDimension(i);
+		triggerIndex.setDimension(i);
 	}
 
 	void EntityContainer::unregisterObject(Entity* object)
 	{
-		std::string objId = object->getStringId();
+		EntityKey objId = object->getKey();
 		objects.erase(objId);
+		activeObjects.erase(objId);
+		sleepingObjects.erase(objId);
 		inputHandlers.erase(objId);
+		removeEventSubscriber(object);
 		uninitiatedEntities.erase(objId);
+		dequeueKill(object);
+		awaitAsyncInit(object);
 		if (object->getEntityProperties().isCollidable()) {
 			collidableObjects.erase(objId);
 		}
+		object->getEntityProperties().setWakeCallback(nullptr);
+		object->getEntityProperties().setSleeping(false);
 
 		clearObjectFromCurrentPartitions(object);
+		removeObjectFromIndexes(object);
+		contactManager.removeEntity(object, nullptr);
 
 		for (auto it = layeredObjects.begin(); it != layeredObjects.end();
 		     it++) {
-			it->second.erase(objId);
+			if (it->second.erase(objId) != 0) {
+				invalidateLayer(it->first);
+			}
 		}
 	}
 
 	void EntityContainer::reinitLayerMap()
 	{
+		clearLayerCaches();
 		layeredObjects.clear();
 		ObjectList list;
 		layeredObjects[-1] = list;
 	}
 
-	bool EntityContainer::isUninitiated(const std::string& id) const
+	bool EntityContainer::isUninitiated(const EntityKey& key) const
+	{
+		return uninitiatedEntities.find(key) != uninitiatedEntities.end();
+	}
+
+	void EntityContainer::destroyObject(Entity* object)
 	{
-		return uninitiatedEntities.find(id) != uninitiatedEntities.end();
+		if (componentRegistry != nullptr) {
+			componentRegistry->destroy(object->getKey());
+		}
+		awaitAsyncInit(object);
+		Uint64 id = object->getKey().value;
+		delete object;
+		UID::release(id);
+	}
+
+	void EntityContainer::awaitAsyncInit(Entity* object)
+	{
+		if (object->initStage.load(std::memory_order_acquire) !=
+		    INIT_RUNNING) {
+			return;
+		}
+
+		// Don't wait for a job queued behind others, drop it. A job that
+		// has started only has its own initAsync left to finish.
+		if (jobPool == nullptr || !jobPool->cancel(object->initJob)) {
+			while (object->initStage.load(std::memory_order_acquire) ==
+			       INIT_RUNNING) {
+				std::this_thread::yield();
+			}
+		}
+		object->initStage.store(INIT_PENDING, std::memory_order_relaxed);
+	}
+
+	void EntityContainer::setJobPool(JobPool* pool) { jobPool = pool; }
+
+	void EntityContainer::setInitBudget(float milliseconds)
+	{
+		initBudget = milliseconds > 0.0f ? milliseconds : 0.0f;
+	}
+
+	size_t EntityContainer::getUninitiatedCount() const
+	{
+		return uninitiatedEntities.size();
+	}
+
+	void EntityContainer::dequeueKill(Entity* object)
+	{
+		object->killQueue = nullptr;
+		if (object->killQueued) {
+			object->killQueued = false;
+			killQueue.erase(
+			  std::find(killQueue.begin(), killQueue.end(), object));
+		}
+	}
+
+	void EntityContainer::setComponentRegistry(ComponentRegistry* registry)
+	{
+		componentRegistry = registry;
+	}
+
+	void EntityContainer::setTypeHooks(const std::type_index& type,
+	                                   Uint32 hooks,
+	                                   const BatchHook& moveAll)
+	{
+		auto it = typeHooks.find(type);
+		if (it != typeHooks.end() && it->second.moveAll) {
+			batchTypeCount--;
+		}
+		if (moveAll) {
+			hooks = (hooks & ~HOOK_PRE_MOVE) | HOOK_BATCH_MOVE;
+			batchTypeCount++;
+		}
+		TypeHooks& entry = typeHooks[type];
+		entry.hooks = hooks;
+		entry.moveAll = moveAll;
+		entry.group.clear();
+
+		for (auto& object : objects) {
+			if (std::type_index(typeid(*object.second)) == type) {
+				applyTypeHooks(object.second);
+			}
+		}
+	}
+
+	void EntityContainer::applyTypeHooks(Entity* entity)
+	{
+		// Keyed on the dynamic type, getType values aren't unique
+		auto it = typeHooks.find(std::type_index(typeid(*entity)));
+		if (it == typeHooks.end()) {
+			entity->hooks = static_cast<Uint32>(HOOK_ALL);
+			entity->hookGroup = nullptr;
+			return;
+		}
+		entity->hooks = it->second.hooks;
+		entity->hookGroup = &it->second.group;
+	}
+
+	void EntityContainer::runBatchHooks(const GameData* data)
+	{
+		for (auto& object : activeObjects) {
+			Entity* entity = object.second;
+			if ((entity->hooks & HOOK_BATCH_MOVE) != 0 &&
+			    !isUninitiated(object.first)) {
+				entity->hookGroup->push_back(entity);
+			}
+		}
+
+		for (auto& it : typeHooks) {
+			TypeHooks& type = it.second;
+			if (!type.group.empty()) {
+				type.moveAll(type.group.data(), type.group.size(), data);
+				type.group.clear();
+			}
+		}
 	}
 
 	void EntityContainer::unregisterAllObjects()
+	{
+		clearObjects();
+		reinitLayerMap();
+	}
+
+	void EntityContainer::clearObjects()
 	{
 		for (auto it = objects.begin(); it != objects.end(); it++) {
-			delete it->second;
+			destroyObject(it->second);
 		}
 		uninitiatedEntities.clear();
+		killQueue.clear();
 		objects.clear();
+		activeObjects.clear();
+		sleepingObjects.clear();
+		scheduledWakes.clear();
 		collidableObjects.clear();
 		spatialPartitionMap.clear();
+		staticIndex.clear();
+		triggerIndex.clear();
+		contactManager.clear();
 		inputHandlers.clear();
-		reinitLayerMap();
+		eventSubscribers.clear();
 	}
 
 	void EntityContainer::unregisterAllObjectsFor(Layer layer)
@@ -237,21 +758,36 @@ namespace flat2d {
 		if (layeredObjects.find(layer) == layeredObjects.end()) {
 			return;
 		}
+		if (layeredObjects[layer].size() == objects.size()) {
+			// Every object is on the layer, clear the containers whole
+			clearObjects();
+			layeredObjects[layer].clear();
+			invalidateLayer(layer);
+			return;
+		}
 
 		for (auto it = layeredObjects[layer].begin();
 		     it != layeredObjects[layer].end();
 		     it++) {
-			std::string objId = it->second->getStringId();
+			EntityKey objId = it->second->getKey();
 			objects.erase(objId);
+			activeObjects.erase(objId);
+			sleepingObjects.erase(objId);
 			inputHandlers.erase(objId);
+			removeEventSubscriber(it->second);
 			uninitiatedEntities.erase(objId);
 			if (it->second->getEntityProperties().isCollidable()) {
 				collidableObjects.erase(objId);
 			}
-			delete it->second;
+			clearObjectFromCurrentPartitions(it->second);
+			removeObjectFromIndexes(it->second);
+			contactManager.removeEntity(it->second, nullptr);
+			dequeueKill(it->second);
+			destroyObject(it->second);
 		}
 
 		layeredObjects[layer].clear();
+		invalidateLayer(layer);
 	}
 
 	void EntityContainer::initiateEntities(const GameData* gameData)
@@ -259,12 +795,53 @@ namespace flat2d {
 #ifdef FPS_DBG
 		TIME_FUNCTION;
 #endif
-		for (auto it = uninitiatedEntities.begin();
-		     it != uninitiatedEntities.end();
-		     it++) {
-			it->second->init(gameData);
+		Uint64 start = SDL_GetPerformanceCounter();
+		Uint64 budget = 0;
+		if (initBudget > 0.0f) {
+			budget = std::max<Uint64>(
+			  1, initBudget * SDL_GetPerformanceFrequency() / 1000.0f);
+		}
+		bool budgetSpent = false;
+
+		// Entities registered by init are visited in the same pass
+		auto it = uninitiatedEntities.begin();
+		while (it != uninitiatedEntities.end()) {
+			Entity* entity = it->second;
+			if (entity->asyncInit) {
+				int stage = entity->initStage.load(std::memory_order_acquire);
+				if (stage == INIT_PENDING && jobPool != nullptr) {
+					// Start the loading early even if init has to wait
+					entity->initStage.store(INIT_RUNNING,
+					                        std::memory_order_relaxed);
+					entity->initJob = jobPool->submit([entity, gameData]() {
+						entity->initAsync(gameData);
+						entity->initStage.store(INIT_LOADED,
+						                        std::memory_order_release);
+					});
+					it++;
+					continue;
+				} else if (stage == INIT_RUNNING) {
+					it++;
+					continue;
+				} else if (stage == INIT_PENDING && !budgetSpent) {
+					entity->initAsync(gameData);
+				}
+			}
+
+			if (budgetSpent) {
+				it++;
+				continue;
+			}
+
+			// init may register or unregister Entities, find our way back
+			EntityKey key = it->first;
+			entity->initStage.store(INIT_PENDING, std::memory_order_relaxed);
+			entity->init(gameData);
+			uninitiatedEntities.erase(key);
+			it = uninitiatedEntities.upper_bound(key);
+			budgetSpent = budget != 0 &&
+			              SDL_GetPerformanceCounter() - start >= budget;
 		}
-		uninitiatedEntities.clear();
 	}
 
 	void EntityContainer::handleObjects(const SDL_Event& event,
@@ -281,23 +858,152 @@ namespace flat2d {
 			it->second->handle(event);
 			it->second->postHandle(gameData);
 		}
+
+		auto subscribers = eventSubscribers.find(event.type);
+		if (subscribers == eventSubscribers.end()) {
+			return;
+		}
+		for (auto& subscriber : subscribers->second) {
+			if (!isUninitiated(subscriber.first) &&
+			    subscriber.second->acceptsEvent(event)) {
+				subscriber.second->handle(event);
+			}
+		}
 	}
 
-	void EntityContainer::renderObjects(const GameData* data) const
+	void EntityContainer::removeEventSubscriber(const Entity* entity)
+	{
+		EntityKey objId = entity->getKey();
+		for (auto type : entity->getEventSubscriptions()) {
+			auto subscribers = eventSubscribers.find(type);
+			if (subscribers != eventSubscribers.end()) {
+				subscribers->second.erase(objId);
+			}
+		}
+	}
+
+	bool EntityContainer::redrawLayerCache(const ObjectList& list,
+	                                       LayerCache& cache,
+	                                       const GameData* data)
+	{
+		// Entities are cached together, with a single parallax offset
+		cache.usable = false;
+		bool first = true;
+		for (auto& it : list) {
+			if (isUninitiated(it.first)) {
+				// Try again when it's been initiated
+				return false;
+			}
+			const EntityProperties& props = it.second->getEntityProperties();
+			if (it.second->isFixedPosition() ||
+			    (!first && props.getDepth() != cache.depth)) {
+				cache.dirty = false;
+				return false;
+			}
+			cache.depth = props.getDepth();
+			first = false;
+		}
+
+		RenderData* renderData = data->getRenderData();
+		SDL_Renderer* renderer = renderData->getRenderer();
+		Camera* camera = renderData->getCamera();
+		if (cache.texture == nullptr) {
+			cache.texture = SDL_CreateTexture(renderer,
+			                                  SDL_PIXELFORMAT_RGBA8888,
+			                                  SDL_TEXTUREACCESS_TARGET,
+			                                  camera->getMapWidth(),
+			                                  camera->getMapHeight());
+			if (cache.texture == nullptr) {
+				cache.dirty = false;
+				return false;
+			}
+			SDL_SetTextureBlendMode(cache.texture, SDL_BLENDMODE_BLEND);
+		}
+
+		// Render the layer in world coordinates
+		Camera cacheCamera(camera->getMapWidth(), camera->getMapHeight());
+		cacheCamera.setMapDimensions(camera->getMapWidth(),
+		                             camera->getMapHeight());
+		RenderData cacheData(renderer, &cacheCamera);
+
+		SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+		SDL_SetRenderTarget(renderer, cache.texture);
+		SDL_SetRenderDrawColor(renderer, 0x0, 0x0, 0x0, 0x0);
+		SDL_RenderClear(renderer);
+		for (auto& it : list) {
+			Entity* entity = it.second;
+			if ((entity->hooks & HOOK_PRE_RENDER) != 0) {
+				entity->preRender(data);
+			}
+			entity->render(&cacheData);
+			if ((entity->hooks & HOOK_POST_RENDER) != 0) {
+				entity->postRender(data);
+			}
+		}
+		SDL_SetRenderTarget(renderer, previousTarget);
+
+		cache.dirty = false;
+		cache.usable = true;
+		return true;
+	}
+
+	bool EntityContainer::renderCachedLayer(const ObjectList& list,
+	                                        LayerCache& cache,
+	                                        const GameData* data)
+	{
+		RenderData* renderData = data->getRenderData();
+		Camera* camera = renderData->getCamera();
+		if (camera == nullptr) {
+			return false;
+		}
+		if (cache.dirty && !redrawLayerCache(list, cache, data)) {
+			return false;
+		}
+		if (!cache.usable) {
+			return false;
+		}
+
+		// Copy the part of the map the camera sees at the layer depth
+		SDL_Point offset = renderData->getCameraOffset(cache.depth);
+		SDL_Rect box = camera->getBox();
+		SDL_Rect view = { offset.x, offset.y, box.w, box.h };
+		SDL_Rect map = { 0, 0, camera->getMapWidth(), camera->getMapHeight() };
+		SDL_Rect source;
+		if (SDL_IntersectRect(&view, &map, &source)) {
+			SDL_Rect target = {
+				source.x - offset.x, source.y - offset.y, source.w, source.h
+			};
+			SDL_RenderCopy(
+			  renderData->getRenderer(), cache.texture, &source, &target);
+		}
+		return true;
+	}
+
+	void EntityContainer::renderObjects(const GameData* data)
 	{
 #ifdef FPS_DBG
 		TIME_FUNCTION;
 #endif
 		for (auto it1 = layeredObjects.begin(); it1 != layeredObjects.end();
 		     it1++) {
+			auto cache = layerCaches.find(it1->first);
+			if (cache != layerCaches.end() &&
+			    renderCachedLayer(it1->second, cache->second, data)) {
+				continue;
+			}
 			for (auto it2 = it1->second.begin(); it2 != it1->second.end();
 			     it2++) {
 				if (isUninitiated(it2->first)) {
 					continue;
 				}
-				it2->second->preRender(data);
-				it2->second->render(data->getRenderData());
-				it2->second->postRender(data);
+				Entity* entity = it2->second;
+				if ((entity->hooks & HOOK_PRE_RENDER) != 0) {
+					entity->preRender(data);
+				}
+				entity->render(data->getRenderData());
+				if ((entity->hooks & HOOK_POST_RENDER) != 0) {
+					entity->postRender(data);
+				}
 			}
 		}
 	}
@@ -310,28 +1016,71 @@ namespace flat2d {
 		float deltatime = dtMonitor->getDeltaTime();
 		CollisionDetector* coldetector = data->getCollisionDetector();
 
-		for (auto& object : objects) {
+		simulationTime += deltatime;
+		if (!scheduledWakes.empty()) {
+			wakeScheduledObjects();
+		}
+
+		if (batchTypeCount != 0) {
+			runBatchHooks(data);
+		}
+
+		std::vector<Entity*> idleObjects;
+		for (auto& object : activeObjects) {
 			if (isUninitiated(object.first)) {
 				continue;
 			}
-			object.second->preMove(data);
+			Uint32 hooks = object.second->hooks;
+			if ((hooks & HOOK_PRE_MOVE) != 0) {
+				object.second->preMove(data);
+			}
 			handlePossibleObjectMovement(object.second);
 
 			EntityProperties& props = object.second->getEntityProperties();
-			if (props.isMoving()) {
-				if (props.isCollidable()) {
-					coldetector->handlePossibleCollisionsFor(object.second,
+			bool collidable = props.isCollidable() && !props.isTrigger();
+			if (props.isMoving() && !props.isStatic()) {
+				if (collidable && props.hasContinuousCollision()) {
+					coldetector->handleContinuousMovementFor(object.second,
 					                                         data);
+				} else {
+					if (collidable) {
+						coldetector->handlePossibleCollisionsFor(
+						  object.second, data);
+					}
+					props.move(deltatime);
 				}
-				props.move(deltatime);
 				handlePossibleObjectMovement(object.second);
 			}
 
-			object.second->postMove(data);
-			handlePossibleObjectMovement(object.second);
+			if ((hooks & HOOK_POST_MOVE) != 0) {
+				object.second->postMove(data);
+				handlePossibleObjectMovement(object.second);
+			}
+
+			if (collidable && !props.isStatic() && triggerIndex.size() != 0) {
+				handleTriggersFor(object.second);
+			}
+
+			if (sleepThreshold != 0 && !props.isMoving() &&
+			    props.incrementIdleFrames() >= sleepThreshold) {
+				idleObjects.push_back(object.second);
+			}
 		}
 
-		clearDeadObjects();
+		// Objects can be woken by collisions after they were found idle
+		for (auto it = idleObjects.begin(); it != idleObjects.end(); it++) {
+			if ((*it)->getEntityProperties().getIdleFrames() >=
+			    sleepThreshold) {
+				deactivateObject(*it);
+			}
+		}
+
+		clearDeadObjects(data);
+		contactManager.endStep(data);
+
+		if (dtMonitor->isFixedTimestep()) {
+			lastStateHash = computeStateHash();
+		}
 	}
 
 	void EntityContainer::handlePossibleObjectMovement(Entity* entity)
@@ -340,7 +1089,24 @@ namespace flat2d {
 		// function that was injected into the objects entity properties???
 		// Multiple calls to this function seems wasteful although it filters
 		// nicely with the hasLocationChanged flag.
-		if (entity->getEntityProperties().hasLocationChanged()) {
+		EntityProperties& props = entity->getEntityProperties();
+		if (!layerCaches.empty() && props.hasLocationChanged()) {
+			invalidateLayerOf(entity);
+		}
+		if (props.isTrigger()) {
+			if (props.hasLocationChanged()) {
+				triggerIndex.invalidate();
+				props.setLocationChanged(false);
+			}
+			return;
+		}
+		if (props.isStatic()) {
+			// Static bodies are never re-partitioned
+			props.setLocationChanged(false);
+			return;
+		}
+
+		if (props.hasLocationChanged()) {
 			clearObjectFromCurrentPartitions(entity);
 			registerObjectToSpatialPartitions(entity);
 			entity->getEntityProperties().setLocationChanged(false);
@@ -363,31 +1129,275 @@ namespace flat2d {
 		return collidableObjects.size();
 	}
 
-	void EntityContainer::clearDeadObjects()
+	void EntityContainer::clearDeadObjects(const GameData* data)
 	{
-		std::vector<std::string> objectsToErase;
-		for (auto it = objects.begin(); it != objects.end(); it++) {
-			if (!it->second->isDead()) {
-				continue;
+		if (deadObjectScan) {
+			// Catches Entities that die without calling setDead
+			for (auto& object : objects) {
+				Entity* entity = object.second;
+				if (!entity->killQueued && entity->isDead()) {
+					entity->killQueued = true;
+					killQueue.push_back(entity);
+				}
 			}
-			std::string objId = it->first;
-			collidableObjects.erase(objId);
-			for (auto layerIt = layeredObjects.begin();
-			     layerIt != layeredObjects.end();
-			     layerIt++) {
-				layerIt->second.erase(objId);
+		}
+
+		// Contact callbacks can kill more Entities, take them next round
+		std::vector<Entity*> deadObjects;
+		while (!killQueue.empty()) {
+			deadObjects.clear();
+			deadObjects.swap(killQueue);
+
+			// Unlink the whole batch first so callbacks never see a
+			// half removed Entity
+			size_t count = 0;
+			for (auto entity : deadObjects) {
+				entity->killQueued = false;
+				if (!entity->isDead()) {
+					continue;
+				}
+				deadObjects[count++] = entity;
+
+				EntityKey objId = entity->getKey();
+				objects.erase(objId);
+				collidableObjects.erase(objId);
+				activeObjects.erase(objId);
+				sleepingObjects.erase(objId);
+				inputHandlers.erase(objId);
+				removeEventSubscriber(entity);
+				uninitiatedEntities.erase(objId);
+				layeredObjects[entity->layer].erase(objId);
+				invalidateLayer(entity->layer);
+				clearObjectFromCurrentPartitions(entity);
+				removeObjectFromIndexes(entity);
+				entity->killQueue = nullptr;
+			}
+			deadObjects.resize(count);
+
+			for (auto entity : deadObjects) {
+				contactManager.removeEntity(entity, data);
+			}
+			for (auto entity : deadObjects) {
+				destroyObject(entity);
 			}
-			clearObjectFromCurrentPartitions(it->second);
-			objectsToErase.push_back(objId);
-			delete it->second;
 		}
+	}
 
-		for (auto it = objectsToErase.begin(); it != objectsToErase.end();
-		     it++) {
-			objects.erase(*it);
+	Uint64 EntityContainer::computeStateHash() const
+	{
+		// FNV-1a over the state of every Entity in id order
+		Uint64 hash = 14695981039346656037ULL;
+		auto mix = [&hash](const void* data, size_t size) {
+			const Uint8* bytes = static_cast<const Uint8*>(data);
+			for (size_t i = 0; i < size; i++) {
+				hash ^= bytes[i];
+				hash *= 1099511628211ULL;
+			}
+		};
+
+		for (auto& object : objects) {
+			const EntityProperties& props =
+			  object.second->getEntityProperties();
+			Sint32 values[] = { props.getXpos(), props.getYpos() };
+			float velocities[] = { props.getXvel(), props.getYvel() };
+			mix(&object.first.value, sizeof(object.first.value));
+			mix(values, sizeof(values));
+			mix(velocities, sizeof(velocities));
+		}
+		return hash;
+	}
+
+	Uint64 EntityContainer::getLastStateHash() const { return lastStateHash; }
+
+	void EntityContainer::takeSnapshot(Snapshot* snapshot) const
+	{
+		snapshot->clear();
+		snapshot->write(simulationTime);
+		snapshot->write(static_cast<Uint32>(scheduledWakes.size()));
+		for (auto& wake : scheduledWakes) {
+			snapshot->write(wake.first);
+			snapshot->write(wake.second.value);
+		}
+
+		snapshot->write(static_cast<Uint32>(objects.size()));
+		for (auto& object : objects) {
+			const Entity* entity = object.second;
+			const EntityProperties& props = entity->getEntityProperties();
+
+			EntityState state;
+			std::memset(&state, 0, sizeof(state));
+			state.key = entity->getKey().value;
+			state.x = props.x;
+			state.y = props.y;
+			state.w = props.w;
+			state.h = props.h;
+			state.z = props.z;
+			state.xvel = props.xvel;
+			state.yvel = props.yvel;
+			state.collider = props.colliderShape;
+			state.category = props.collisionCategory;
+			state.mask = props.collisionMask;
+			state.idleFrames = props.idleFrames;
+			state.flags = (props.collidable ? STATE_COLLIDABLE : 0) |
+			              (props.staticBody ? STATE_STATIC : 0) |
+			              (props.continuousCollision ? STATE_CONTINUOUS : 0) |
+			              (props.trigger ? STATE_TRIGGER : 0) |
+			              (props.visible ? STATE_VISIBLE : 0) |
+			              (props.sleeping ? STATE_SLEEPING : 0) |
+			              (entity->isDead() ? STATE_DEAD : 0);
+
+			// Write the custom state and then the size of it
+			size_t position = snapshot->size();
+			snapshot->write(state);
+			entity->writeState(snapshot);
+			state.customSize =
+			  static_cast<Uint32>(snapshot->size() - position - sizeof(state));
+			snapshot->writeAt(position, &state, sizeof(state));
 		}
 	}
 
+	bool EntityContainer::restoreSnapshot(Snapshot* snapshot)
+	{
+		if (UID::isRecycling()) {
+			// A recycled id could match a newer Entity in the snapshot
+			return false;
+		}
+		snapshot->setReadPosition(0);
+
+		float time;
+		Uint32 wakeCount;
+		if (!snapshot->read(&time) || !snapshot->read(&wakeCount)) {
+			return false;
+		}
+
+		std::multimap<float, EntityKey> wakes;
+		for (Uint32 i = 0; i < wakeCount; i++) {
+			float wakeTime;
+			EntityKey key;
+			if (!snapshot->read(&wakeTime) || !snapshot->read(&key.value)) {
+				return false;
+			}
+			wakes.insert(std::make_pair(wakeTime, key));
+		}
+
+		Uint32 count;
+		if (!snapshot->read(&count)) {
+			return false;
+		}
+
+		// Both the snapshot and the objects are in id order, walk them
+		// together
+		bool repopulate = false;
+		auto it = objects.begin();
+		for (Uint32 i = 0; i < count; i++) {
+			EntityState state;
+			if (!snapshot->read(&state)) {
+				return false;
+			}
+			size_t next = snapshot->getReadPosition() + state.customSize;
+
+			// Registered after the snapshot was taken
+			while (it != objects.end() && it->first.value < state.key) {
+				it->second->setDead(true);
+				it++;
+			}
+
+			if (it != objects.end() && it->first.value == state.key) {
+				repopulate |= restoreEntity(it->second, state, snapshot);
+				it++;
+			}
+			snapshot->setReadPosition(next);
+		}
+		for (; it != objects.end(); it++) {
+			it->second->setDead(true);
+		}
+
+		simulationTime = time;
+		scheduledWakes.swap(wakes);
+		contactManager.clear();
+		if (repopulate) {
+			repopulateCollidables();
+		}
+		for (auto& it : layerCaches) {
+			it.second.dirty = true;
+		}
+		return true;
+	}
+
+	bool EntityContainer::restoreEntity(Entity* entity,
+	                                    const EntityState& state,
+	                                    Snapshot* snapshot)
+	{
+		EntityProperties& props = entity->getEntityProperties();
+		bool collidable = (state.flags & STATE_COLLIDABLE) != 0;
+		bool staticBody = (state.flags & STATE_STATIC) != 0;
+		bool trigger = (state.flags & STATE_TRIGGER) != 0;
+		bool sleeping = (state.flags & STATE_SLEEPING) != 0;
+		bool indexChanged = props.collidable != collidable ||
+		                    props.staticBody != staticBody ||
+		                    props.trigger != trigger;
+		bool moved = props.x != state.x || props.y != state.y ||
+		             props.w != state.w || props.h != state.h ||
+		             std::memcmp(&props.colliderShape,
+		                         &state.collider,
+		                         sizeof(EntityShape)) != 0;
+
+		props.x = state.x;
+		props.y = state.y;
+		props.w = state.w;
+		props.h = state.h;
+		props.z = state.z;
+		props.xvel = state.xvel;
+		props.yvel = state.yvel;
+		props.colliderShape = state.collider;
+		props.collisionCategory = state.category;
+		props.collisionMask = state.mask;
+		props.idleFrames = state.idleFrames;
+		props.collidable = collidable;
+		props.staticBody = staticBody;
+		props.trigger = trigger;
+		props.continuousCollision = (state.flags & STATE_CONTINUOUS) != 0;
+		props.visible = (state.flags & STATE_VISIBLE) != 0;
+		props.locationChanged = false;
+		entity->setDead((state.flags & STATE_DEAD) != 0);
+
+		if (sleeping && !props.sleeping) {
+			deactivateObject(entity);
+		} else if (!sleeping && props.sleeping) {
+			props.sleeping = false;
+			activateObject(entity);
+		}
+
+		if (moved && !indexChanged) {
+			if (trigger) {
+				triggerIndex.invalidate();
+			} else if (staticBody) {
+				staticIndex.invalidate();
+			} else {
+				clearObjectFromCurrentPartitions(entity);
+				registerObjectToSpatialPartitions(entity);
+			}
+		}
+
+		entity->readState(snapshot);
+		return indexChanged;
+	}
+
+	ContactManager& EntityContainer::getContactManager()
+	{
+		return contactManager;
+	}
+
+	size_t EntityContainer::getStaticCollidablesCount() const
+	{
+		return staticIndex.size();
+	}
+
+	size_t EntityContainer::getTriggerCount() const
+	{
+		return triggerIndex.size();
+	}
+
 	size_t EntityContainer::getSpatialPartitionCount() const
 	{
 		return spatialPartitionMap.size();
@@ -402,55 +1412,66 @@ namespace flat2d {
 		}
 	}
 
-	void EntityContainer::iterateCollidablesFor(const Entity* source,
-	                                            EntityIter func)
+	size_t EntityContainer::iterateCollidablesFor(const Entity* source,
+	                                              EntityIter func)
 	{
+		const EntityProperties& sourceProps = source->getEntityProperties();
+		if (sourceProps.isStatic()) {
+			return 0;
+		}
+
 		const EntityProperties::Areas& currentAreas =
-		  source->getEntityProperties().getCurrentAreas();
+		  sourceProps.getCurrentAreas();
 		std::map<float, Entity*> sortedMap;
-		EntityShape colliderShape =
-		  source->getEntityProperties().getColliderShape();
+		EntityShape colliderShape = sourceProps.getColliderShape();
 		float sx = static_cast<float>(colliderShape.x + (colliderShape.w / 2));
 		float sy = static_cast<float>(colliderShape.y + (colliderShape.h / 2));
 
-		// Itterate the objects and sort them according to distance
-		for (auto& area : currentAreas) {
-			for (auto& object : spatialPartitionMap[area]) {
-				if (!object.second->getEntityProperties().isCollidable()) {
-					continue;
-				}
-				if (*source == *object.second) {
-					continue;
-				}
+		size_t filtered = 0;
+		queryStamp++;
+		auto sortByDistance = [&](Entity* object) {
+			EntityProperties& props = object->getEntityProperties();
+			if (props.queryStamp == queryStamp || !props.isCollidable()) {
+				return;
+			}
+			props.queryStamp = queryStamp;
+			if (*source == *object) {
+				return;
+			}
 
-				const EntityShape& targetShape =
-				  object.second->getEntityProperties().getColliderShape();
-				float tx =
-				  static_cast<float>(targetShape.x + (targetShape.w / 2));
-				float ty =
-				  static_cast<float>(targetShape.y + (targetShape.h / 2));
-
-				float distance;
-				if (sx == tx) {
-					distance = static_cast<float>(std::abs(sy - ty));
-				} else if (sy == ty) {
-					distance = static_cast<float>(std::abs(sx - tx));
-				} else {
-					distance = sqrt(pow(sx - tx, 2) + pow(sy - ty, 2));
-				}
+			// Filter the pair before paying for the distance sort
+			if (!sourceProps.canCollideWith(props)) {
+				filtered++;
+				return;
+			}
 
-				if (sortedMap.find(distance) != sortedMap.end()) {
-					if (*sortedMap[distance] == *object.second) {
-						continue;
-					}
-				}
+			const EntityShape& targetShape =
+			  object->getEntityProperties().getColliderShape();
+			float tx = static_cast<float>(targetShape.x + (targetShape.w / 2));
+			float ty = static_cast<float>(targetShape.y + (targetShape.h / 2));
+
+			float distance;
+			if (sx == tx) {
+				distance = static_cast<float>(std::abs(sy - ty));
+			} else if (sy == ty) {
+				distance = static_cast<float>(std::abs(sx - tx));
+			} else {
+				distance = sqrt(pow(sx - tx, 2) + pow(sy - ty, 2));
+			}
 
-				while (sortedMap.find(distance) != sortedMap.end()) {
-					distance += 0.00001f;
-				}
+			while (sortedMap.find(distance) != sortedMap.end()) {
+				distance += 0.00001f;
+			}
+
+			sortedMap[distance] = object;
+		};
 
-				sortedMap[distance] = object.second;
+		// Itterate the objects and sort them according to distance
+		for (auto& area : currentAreas) {
+			for (auto& object : spatialPartitionMap[area]) {
+				sortByDistance(object.second);
 			}
+			staticIndex.forEachIn(area, sortByDistance);
 		}
 
 		// Itterate the sorted objects and call the cb function
@@ -458,6 +1479,30 @@ namespace flat2d {
 		     objectIter++) {
 			func(objectIter->second);
 		}
+		return filtered;
+	}
+
+	size_t EntityContainer::iterateCollidablesOverlapping(
+	  const Entity* source,
+	  const EntityShape& area,
+	  EntityIter func)
+	{
+		const EntityProperties& sourceProps = source->getEntityProperties();
+		size_t filtered = 0;
+		queryStamp++;
+		forEachCollidableIn(area, [&](Entity* object) {
+			const EntityProperties& props = object->getEntityProperties();
+			if (object == source ||
+			    !shapesOverlap(area, props.getColliderShape())) {
+				return;
+			}
+			if (!sourceProps.canCollideWith(props)) {
+				filtered++;
+				return;
+			}
+			func(object);
+		});
+		return filtered;
 	}
 
 	Entity* EntityContainer::checkAllObjects(EntityProcessor func) const
@@ -498,6 +1543,16 @@ namespace flat2d {
 					return objectIter->second;
 				}
 			}
+
+			Entity* match = nullptr;
+			staticIndex.forEachIn(*areaIter, [&match, &func](Entity* object) {
+				if (match == nullptr && func(object)) {
+					match = object;
+				}
+			});
+			if (match != nullptr) {
+				return match;
+			}
 		}
 		return nullptr;
 	}
@@ -516,4 +1571,251 @@ namespace flat2d {
 			}
 		}
 	}
+
+	template<typename Func>
+	void EntityContainer::forEachCollidableInPartition(const MapArea& area,
+	                                                   Func func)
+	{
+		auto visit = [this, &func](Entity* object) {
+			EntityProperties& props = object->getEntityProperties();
+			if (props.queryStamp == queryStamp || !props.isCollidable()) {
+				return;
+			}
+			props.queryStamp = queryStamp;
+			func(object);
+		};
+
+		auto partition = spatialPartitionMap.find(area);
+		if (partition != spatialPartitionMap.end()) {
+			for (auto& object : partition->second) {
+				visit(object.second);
+			}
+		}
+		staticIndex.forEachIn(area, visit);
+	}
+
+	template<typename Func>
+	void EntityContainer::forEachCollidableIn(const EntityShape& area,
+	                                          Func func)
+	{
+		int xmax = area.x + area.w;
+		int ymax = area.y + area.h;
+		int step = static_cast<int>(spatialPartitionDimension);
+
+		for (int i = area.x;; i = std::min(i + step, xmax)) {
+			for (int j = area.y;; j = std::min(j + step, ymax)) {
+				forEachCollidableInPartition(
+				  MapArea::partitionFor(i, j, spatialPartitionDimension),
+				  func);
+				if (j >= ymax) {
+					break;
+				}
+			}
+			if (i >= xmax) {
+				break;
+			}
+		}
+	}
+
+	size_t EntityContainer::queryRect(const EntityShape& area,
+	                                  Entity** result,
+	                                  size_t capacity)
+	{
+		size_t count = 0;
+		queryStamp++;
+		forEachCollidableIn(area, [&](Entity* object) {
+			if (count < capacity &&
+			    shapesOverlap(
+			      area, object->getEntityProperties().getColliderShape())) {
+				result[count++] = object;
+			}
+		});
+		return count;
+	}
+
+	size_t EntityContainer::queryCircle(int x,
+	                                    int y,
+	                                    int radius,
+	                                    Entity** result,
+	                                    size_t capacity)
+	{
+		size_t count = 0;
+		EntityShape area = { x - radius, y - radius, radius * 2, radius * 2 };
+		float maxDistance = static_cast<float>(radius);
+
+		queryStamp++;
+		forEachCollidableIn(area, [&](Entity* object) {
+			if (count < capacity &&
+			    distanceToEntity(x, y, object) <= maxDistance) {
+				result[count++] = object;
+			}
+		});
+		return count;
+	}
+
+	size_t EntityContainer::queryNearest(int x,
+	                                     int y,
+	                                     int maxDistance,
+	                                     Entity** result,
+	                                     size_t k)
+	{
+		if (k == 0) {
+			return 0;
+		}
+
+		size_t count = 0;
+		auto insert = [&](Entity* object) {
+			float distance = distanceToEntity(x, y, object);
+			if (distance > static_cast<float>(maxDistance)) {
+				return;
+			}
+			if (count == k &&
+			    distance >= distanceToEntity(x, y, result[k - 1])) {
+				return;
+			}
+
+			// Keep the result sorted on distance
+			size_t i = count < k ? count++ : k - 1;
+			while (i > 0 && distanceToEntity(x, y, result[i - 1]) > distance) {
+				result[i] = result[i - 1];
+				i--;
+			}
+			result[i] = object;
+		};
+
+		int dim = static_cast<int>(spatialPartitionDimension);
+		int cx = partitionIndex(x, dim);
+		int cy = partitionIndex(y, dim);
+		int rings = maxDistance / dim + 1;
+
+		// Search rings of partitions around the point until nothing closer
+		// can be found
+		queryStamp++;
+		for (int r = 0; r <= rings; r++) {
+			for (int i = cx - r; i <= cx + r; i++) {
+				forEachCollidableInPartition(
+				  MapArea(i * dim, (cy - r) * dim, dim), insert);
+				if (r != 0) {
+					forEachCollidableInPartition(
+					  MapArea(i * dim, (cy + r) * dim, dim), insert);
+				}
+			}
+			for (int j = cy - r + 1; j < cy + r; j++) {
+				forEachCollidableInPartition(
+				  MapArea((cx - r) * dim, j * dim, dim), insert);
+				forEachCollidableInPartition(
+				  MapArea((cx + r) * dim, j * dim, dim), insert);
+			}
+
+			if (count == k &&
+			    distanceToEntity(x, y, result[k - 1]) <= r * dim) {
+				break;
+			}
+		}
+
+		return count;
+	}
+
+	bool EntityContainer::raycast(int x1, int y1, int x2, int y2, RayHit* hit)
+	{
+		return castRay(x1, y1, x2, y2, hit, 1, true) != 0;
+	}
+
+	size_t EntityContainer::raycastAll(int x1,
+	                                   int y1,
+	                                   int x2,
+	                                   int y2,
+	                                   RayHit* hits,
+	                                   size_t capacity)
+	{
+		return castRay(x1, y1, x2, y2, hits, capacity, false);
+	}
+
+	size_t EntityContainer::castRay(int x1,
+	                                int y1,
+	                                int x2,
+	                                int y2,
+	                                RayHit* hits,
+	                                size_t capacity,
+	                                bool firstOnly)
+	{
+		if (capacity == 0) {
+			return 0;
+		}
+
+		const float infinity = std::numeric_limits<float>::infinity();
+		float dx = static_cast<float>(x2 - x1);
+		float dy = static_cast<float>(y2 - y1);
+		float length = std::sqrt(dx * dx + dy * dy);
+		size_t count = 0;
+
+		auto insert = [&](Entity* object) {
+			RayHit hit;
+			if (!intersectRay(static_cast<float>(x1),
+			                  static_cast<float>(y1),
+			                  dx,
+			                  dy,
+			                  object->getEntityProperties().getColliderShape(),
+			                  &hit)) {
+				return;
+			}
+			hit.entity = object;
+			hit.distance *= length;
+			if (count == capacity && hit.distance >= hits[count - 1].distance) {
+				return;
+			}
+
+			// Keep the hits sorted on distance
+			size_t i = count < capacity ? count++ : capacity - 1;
+			while (i > 0 && hits[i - 1].distance > hit.distance) {
+				hits[i] = hits[i - 1];
+				i--;
+			}
+			hits[i] = hit;
+		};
+
+		// Walk the partitions along the ray in order
+		int dim = static_cast<int>(spatialPartitionDimension);
+		int cx = partitionIndex(x1, dim);
+		int cy = partitionIndex(y1, dim);
+		int ex = partitionIndex(x2, dim);
+		int ey = partitionIndex(y2, dim);
+		int stepX = dx > 0.0f ? 1 : (dx < 0.0f ? -1 : 0);
+		int stepY = dy > 0.0f ? 1 : (dy < 0.0f ? -1 : 0);
+		float tMaxX = infinity;
+		float tMaxY = infinity;
+		float tDeltaX = infinity;
+		float tDeltaY = infinity;
+		if (stepX != 0) {
+			tMaxX = ((stepX > 0 ? cx + 1 : cx) * dim - x1) / dx;
+			tDeltaX = dim / std::abs(dx);
+		}
+		if (stepY != 0) {
+			tMaxY = ((stepY > 0 ? cy + 1 : cy) * dim - y1) / dy;
+			tDeltaY = dim / std::abs(dy);
+		}
+
+		queryStamp++;
+		int cells = std::abs(ex - cx) + std::abs(ey - cy) + 1;
+		for (int i = 0; i < cells; i++) {
+			forEachCollidableInPartition(MapArea(cx * dim, cy * dim, dim),
+			                             insert);
+
+			// Nothing in later partitions can be closer than this hit
+			float exitDistance = std::min(tMaxX, tMaxY) * length;
+			if (firstOnly && count != 0 && hits[0].distance <= exitDistance) {
+				break;
+			}
+
+			if (tMaxX < tMaxY) {
+				cx += stepX;
+				tMaxX += tDeltaX;
+			} else {
+				cy += stepY;
+				tMaxY += tDeltaY;
+			}
+		}
+
+		return count;
+	}
 } // namespace flat2d
@@ -6,10 +6,17 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
 #include <vector>
 
+#include "ContactManager.h"
+#include "Entity.h"
+#include "EntityKey.h"
 #include "EntityShape.h"
 #include "MapArea.h"
+#include "StaticSpatialIndex.h"
 
 namespace flat2d {
 	// Forward declarations
@@ -18,13 +25,27 @@ namespace flat2d {
 	class RenderData;
 	class DeltatimeMonitor;
 	class EntityProperties;
+	class Snapshot;
+	class ComponentRegistry;
+	class JobPool;
 
 	typedef int Layer;
-	typedef std::map<std::string, Entity*> ObjectList;
+	typedef std::map<EntityKey, Entity*> ObjectList;
 	typedef std::map<Layer, ObjectList> LayerMap;
 	typedef std::map<MapArea, ObjectList> SpatialPartitionMap;
 	typedef std::map<std::string, MapArea*> RenderAreas;
 
+	/**
+	 * A hit produced by the EntityContainer raycast queries
+	 */
+	struct RayHit
+	{
+		Entity* entity;
+		float distance;
+		float normalx;
+		float normaly;
+	};
+
 	/**
 	 * Holds every Entity in the game. Entities registered into the
 	 * EntityContainer will automatically have their update functions called
@@ -41,15 +62,63 @@ namespace flat2d {
 		// TODO(Linus): Maybe make this editable in the future?
 		const int spatialPartitionExpansion = 0;
 		unsigned int spatialPartitionDimension = 100;
+		unsigned int sleepThreshold = 0;
+		bool deadObjectScan = false;
+		unsigned int queryStamp = 0;
+		float simulationTime = 0.0f;
+		Uint64 lastStateHash = 0;
 
 		DeltatimeMonitor* dtMonitor = nullptr;
 
 		ObjectList objects;
+		ObjectList activeObjects;
+		ObjectList sleepingObjects;
 		ObjectList collidableObjects;
 		ObjectList inputHandlers;
+		std::map<Uint32, ObjectList> eventSubscribers;
 		LayerMap layeredObjects;
 		SpatialPartitionMap spatialPartitionMap;
+		StaticSpatialIndex staticIndex;
+		StaticSpatialIndex triggerIndex;
+		ContactManager contactManager;
+		ComponentRegistry* componentRegistry = nullptr;
+		JobPool* jobPool = nullptr;
+		float initBudget = 0.0f;
 		ObjectList uninitiatedEntities;
+		std::vector<Entity*> killQueue;
+		std::multimap<float, EntityKey> scheduledWakes;
+
+		struct EntityState;
+
+		/**
+		 * The render target a cached layer is drawn into
+		 */
+		struct LayerCache
+		{
+			SDL_Texture* texture = nullptr;
+			int depth = 0;
+			bool dirty = true;
+			bool usable = false;
+		};
+		std::map<Layer, LayerCache> layerCaches;
+
+	  public:
+		/**
+		 * A hook updating every active Entity of a type at once
+		 */
+		typedef std::function<
+		  void(Entity* const* entities, size_t count, const GameData* data)>
+		  BatchHook;
+
+	  private:
+		struct TypeHooks
+		{
+			Uint32 hooks;
+			BatchHook moveAll;
+			std::vector<Entity*> group;
+		};
+		std::map<std::type_index, TypeHooks> typeHooks;
+		size_t batchTypeCount = 0;
 
 		typedef std::function<bool(Entity*)> EntityProcessor;
 		typedef std::function<void(Entity*)> EntityIter;
@@ -58,16 +127,69 @@ namespace flat2d {
 		EntityContainer(const EntityContainer&); // Don't implement
 		void operator=(const EntityContainer&);  // Don't implement
 
-		void clearDeadObjects();
+		void clearDeadObjects(const GameData* data);
+		void clearObjects();
 		void registerObjectToSpatialPartitions(Entity* entity);
-		void addObjectToSpatialPartitionFor(Entity* entity, int x, int y);
+		void addObjectToSpatialPartitionFor(Entity* entity,
+		                                    const MapArea& area);
 		void clearObjectFromCurrentPartitions(Entity* entity);
 		void clearObjectFromUnattachedPartitions(Entity* entity);
+		void removeObjectFromIndexes(Entity* entity);
 		EntityShape createBoundingBoxFor(const EntityProperties& props) const;
+		template<typename Func>
+		void forEachPartitionOf(const EntityProperties& props, Func func) const;
 		void handlePossibleObjectMovement(Entity* entity);
+		void handleTriggersFor(Entity* entity);
+		void removeEventSubscriber(const Entity* entity);
+		typedef std::pair<MapArea, Entity*> PartitionCell;
+		typedef std::vector<PartitionCell> PartitionCells;
+		void addObject(Entity* object, Layer layer, PartitionCells* cells);
+		void destroyObject(Entity* object);
+		void dequeueKill(Entity* object);
+		void awaitAsyncInit(Entity* object);
+		void setTypeHooks(const std::type_index& type,
+		                  Uint32 hooks,
+		                  const BatchHook& moveAll);
+		void applyTypeHooks(Entity* entity);
+		void runBatchHooks(const GameData* data);
+
+		template<typename Hook>
+		static bool overrides(Hook hook)
+		{
+			// Inherited hooks are members of Entity, overrides of the type
+			typedef void (Entity::*EntityHookFunction)(const GameData*);
+			return !std::is_same<Hook, EntityHookFunction>::value;
+		}
+
+		bool restoreEntity(Entity* entity,
+		                   const EntityState& state,
+		                   Snapshot* snapshot);
+		void invalidateLayerOf(const Entity* entity);
+		bool redrawLayerCache(const ObjectList& list,
+		                      LayerCache& cache,
+		                      const GameData* data);
+		bool renderCachedLayer(const ObjectList& list,
+		                       LayerCache& cache,
+		                       const GameData* data);
+		void clearLayerCaches();
+		void activateObject(Entity* entity);
+		void deactivateObject(Entity* entity);
+		void wakeScheduledObjects();
 
 		void reinitLayerMap();
-		bool isUninitiated(const std::string& id) const;
+		bool isUninitiated(const EntityKey& key) const;
+
+		template<typename Func>
+		void forEachCollidableInPartition(const MapArea& area, Func func);
+		template<typename Func>
+		void forEachCollidableIn(const EntityShape& area, Func func);
+		size_t castRay(int x1,
+		               int y1,
+		               int x2,
+		               int y2,
+		               RayHit* hits,
+		               size_t capacity,
+		               bool firstOnly);
 
 	  public:
 		static const int DEFAULT_LAYER = -1;
@@ -97,6 +219,36 @@ namespace flat2d {
 		 */
 		std::vector<int> getLayerKeys() const;
 
+		/**
+		 * Render a layer once into a cached texture and copy it to the
+		 * screen every frame instead of rendering its Entity objects. Meant
+		 * for static scenery. The cache is redrawn when Entity objects are
+		 * added to, removed from or moved within the layer. Other changes,
+		 * like animations or textures, require a call to invalidateLayer.
+		 *
+		 * Entities in a cached layer only get their render callbacks when
+		 * the cache is redrawn. The layer is cached with the camera parallax
+		 * of its Entity objects so they should share the same depth. Layers
+		 * holding Entities with mixed depths or fixed positions, or whose
+		 * map doesn't fit in a texture, are rendered normally.
+		 * @param layer The layer
+		 * @param cached true or false
+		 */
+		void setLayerCached(Layer layer, bool cached);
+
+		/**
+		 * Check if a layer is cached
+		 * @param layer The layer
+		 * @return true or false
+		 */
+		bool isLayerCached(Layer layer) const;
+
+		/**
+		 * Redraw the cache of a cached layer before it's next rendered
+		 * @param layer The layer
+		 */
+		void invalidateLayer(Layer layer);
+
 		/**
 		 * Register an Entity to the EntityContainer. If you
 		 * don't provide a layer the DEFAULT_LAYER will be used.
@@ -106,6 +258,21 @@ namespace flat2d {
 		 */
 		void registerObject(Entity*, Layer = DEFAULT_LAYER);
 
+		/**
+		 * Register many Entity objects to a layer at once, for example when
+		 * loading a level. The Entities are inserted in id order and their
+		 * spatial partitions are filled in a single pass, which is a lot
+		 * faster than registering them one by one. As with registerObject
+		 * their init functions are called together at the start of the
+		 * next frame.
+		 * @param entities The Entity objects
+		 * @param count The number of Entity objects
+		 * @param layer An optional layer to register the Entities to
+		 */
+		void registerObjects(Entity* const* entities,
+		                     size_t count,
+		                     Layer layer = DEFAULT_LAYER);
+
 		/**
 		 * Unregister an entity from the EntityContainer
 		 * @param entity the Entity* you want to remove
@@ -143,12 +310,125 @@ namespace flat2d {
 		 */
 		size_t getCollidablesCount() const;
 
+		/**
+		 * Get the number of static collidable Entity objects registered to
+		 * the EntityContainer. Static bodies are kept in a separate spatial
+		 * index and never share the dynamic spatial partitions.
+		 * @return The number of static collidable Entities
+		 */
+		size_t getStaticCollidablesCount() const;
+
+		/**
+		 * Get the number of trigger Entity objects registered to the
+		 * EntityContainer. Triggers are kept in their own spatial index.
+		 * @return The number of triggers
+		 */
+		size_t getTriggerCount() const;
+
+		/**
+		 * Set the ComponentRegistry holding components of registered
+		 * Entity objects (see ComponentRegistry::bridge). The components of
+		 * an Entity are destroyed when the EntityContainer deletes it.
+		 * @param registry The ComponentRegistry or nullptr
+		 */
+		void setComponentRegistry(ComponentRegistry* registry);
+
+		/**
+		 * Set the JobPool running initAsync of Entity objects with
+		 * asynchronous init. Without one initAsync is called on the main
+		 * thread right before init.
+		 * @param pool The JobPool or nullptr
+		 */
+		void setJobPool(JobPool* pool);
+
+		/**
+		 * Limit the time initiateEntities spends calling init each frame.
+		 * Entity objects that don't fit in the budget are initiated on
+		 * the following frames, in registration order, and aren't moved
+		 * or rendered until then. At least one Entity is initiated per
+		 * frame. Defaults to 0 which initiates everything at once, keep
+		 * it that way for deterministic replays.
+		 * @param milliseconds The budget in milliseconds or 0
+		 */
+		void setInitBudget(float milliseconds);
+
+		/**
+		 * Get the number of registered Entity objects waiting for init
+		 * @return The number of uninitiated Entities
+		 */
+		size_t getUninitiatedCount() const;
+
+		/**
+		 * Register an Entity type so the EntityContainer skips the
+		 * pre/postMove and pre/postRender callbacks the type doesn't
+		 * override. Overrides are detected at compile time from the
+		 * declarations in T, callbacks inherited from a class between T
+		 * and Entity are assumed to be overridden. Only Entities whose
+		 * dynamic type is exactly T are affected, classes derived from T
+		 * keep all their callbacks until registered themselves.
+		 *
+		 * An optional batch hook is called once per frame, before the
+		 * Entity objects move, with all active Entities of the type in id
+		 * order. That is creation order for Entities created on one thread
+		 * while UID recycling is off. It replaces their preMove callbacks.
+		 * @param moveAll The batch hook or nullptr
+		 */
+		template<typename T>
+		void registerType(const BatchHook& moveAll = nullptr)
+		{
+			static_assert(std::is_base_of<Entity, T>::value,
+			              "Registered types must derive from Entity");
+			Uint32 hooks = 0;
+			hooks |= overrides(&T::preMove) ? HOOK_PRE_MOVE : 0;
+			hooks |= overrides(&T::postMove) ? HOOK_POST_MOVE : 0;
+			hooks |= overrides(&T::preRender) ? HOOK_PRE_RENDER : 0;
+			hooks |= overrides(&T::postRender) ? HOOK_POST_RENDER : 0;
+			setTypeHooks(std::type_index(typeid(T)), hooks, moveAll);
+		}
+
 		/**
 		 * Get the number of SpatialPartitions created
 		 * @return The number of SpatialPartitions created
 		 */
 		size_t getSpatialPartitionCount() const;
 
+		/**
+		 * Get the number of sleeping Entity objects. Sleeping objects are
+		 * skipped by moveObjects until they are woken.
+		 * @return The number of sleeping Entities
+		 */
+		size_t getSleepingCount() const;
+
+		/**
+		 * Set the number of consecutive frames an Entity has to stay idle
+		 * (no velocity, no movement and no collisions) before it's put to
+		 * sleep. Sleeping Entities still render, handle input and can be
+		 * collided with but don't receive move callbacks. They are woken on
+		 * collisions, velocity or position changes, scheduled wakes or when
+		 * EntityProperties::wake is called. Defaults to 0 which disables
+		 * sleeping.
+		 * @param frames The number of idle frames before sleeping
+		 */
+		void setSleepThreshold(unsigned int frames);
+
+		/**
+		 * Check every registered Entity with isDead after each move.
+		 * Dead Entities are normally found through the queue
+		 * Entity::setDead fills, which costs nothing for the living. Turn
+		 * the scan on for Entity types that set the dead member directly
+		 * or override isDead. Defaults to false.
+		 * @param scan true or false
+		 */
+		void setDeadObjectScan(bool scan);
+
+		/**
+		 * Wake an Entity after a given amount of game time. Useful for
+		 * sleeping Entities that rely on timers in their move callbacks.
+		 * @param entity The Entity to wake
+		 * @param seconds The delay in seconds
+		 */
+		void scheduleWake(const Entity* entity, float seconds);
+
 		/**
 		 * Recheck all registered Entity objects and see if any have become
 		 * collidable after they were registered.
@@ -157,14 +437,18 @@ namespace flat2d {
 
 		/**
 		 * Initiate recently added entities before continuing with
-		 * main game loop. This is called from the engine and
+		 * main game loop. Entities with asynchronous init have their
+		 * initAsync queued on the JobPool and get init on a later frame,
+		 * once it has finished. This is called from the engine and
 		 * should be left untouched in game code
 		 * @param gameData The GameData pointer
 		 */
 		void initiateEntities(const GameData* gameData);
 
 		/**
-		 * Check for input events and notify all registered Entity objects.
+		 * Notify the registered Entity objects of an input event. Entity
+		 * objects subscribed to the event type get a handle call, input
+		 * handlers without subscriptions get every event.
 		 * This is called by the GameEngine and should probably not be used
 		 * by game code.
 		 */
@@ -182,7 +466,53 @@ namespace flat2d {
 		 * This is called by the GameEngine and should probably not be used
 		 * by game code.
 		 */
-		void renderObjects(const GameData*) const;
+		void renderObjects(const GameData*);
+
+		/**
+		 * Compute a hash of the kinematic state (id, position and velocity)
+		 * of every registered Entity in id order. Compare hashes between
+		 * peers or replays to detect desyncs, the ids must then be handed
+		 * out the same way on each side.
+		 * @return The state hash
+		 */
+		Uint64 computeStateHash() const;
+
+		/**
+		 * Get the state hash computed after the last moveObjects call. Only
+		 * computed when the DeltatimeMonitor uses a fixed timestep.
+		 * @return The state hash or 0 if none has been computed
+		 */
+		Uint64 getLastStateHash() const;
+
+		/**
+		 * Save the state of every registered Entity into a Snapshot. The
+		 * EntityProperties (position, velocity, collider, flags, sleep
+		 * state) are saved along with whatever each Entity writes in
+		 * Entity::writeState. Spatial partitions aren't saved, they are
+		 * rebuilt from the positions on restore.
+		 * @param snapshot The Snapshot to write to, previous data is cleared
+		 */
+		void takeSnapshot(Snapshot* snapshot) const;
+
+		/**
+		 * Restore the state saved in a Snapshot. Entity objects registered
+		 * after the Snapshot was taken are marked dead. Entity objects that
+		 * have been deleted since can't be brought back, keep them around
+		 * (hidden) for as long as you might roll back past them. Contacts
+		 * are forgotten and will begin again.
+		 * Fails while UID recycling is enabled since a recycled id could
+		 * belong to a different Entity than the one saved.
+		 * @param snapshot The Snapshot to restore
+		 * @return false if the Snapshot is malformed or ids are recycled
+		 */
+		bool restoreSnapshot(Snapshot* snapshot);
+
+		/**
+		 * Get the ContactManager. Read the contact events from the last
+		 * physics step from it.
+		 * @return The ContactManager
+		 */
+		ContactManager& getContactManager();
 
 		/**
 		 * Set the dimension for spatial partitions.
@@ -211,12 +541,31 @@ namespace flat2d {
 
 		/**
 		 * Iterate all Entities that share a spatial partition with the provided
-		 * Entity. Trigger callback for each occurence. This is used by the
-		 * CollisionDetector and should be avoided in game code.
+		 * Entity. Trigger callback for each occurence. Static bodies are
+		 * included for dynamic sources, a static source gets no callbacks.
+		 * Entities the source can't collide with, see
+		 * EntityProperties::canCollideWith, are skipped before any other
+		 * work. This is used by the CollisionDetector and should be avoided
+		 * in game code.
 		 * @param source The Entity to operate on
 		 * @param func The EntityIter callback func to use
+		 * @return The number of collidables rejected by the collision filter
 		 */
-		void iterateCollidablesFor(const Entity*, EntityIter);
+		size_t iterateCollidablesFor(const Entity*, EntityIter);
+
+		/**
+		 * Call a function once for every collidable Entity, static bodies
+		 * included, whose collider overlaps an area and that the source
+		 * Entity can collide with. Used by the CollisionDetector to sweep
+		 * continuous movement and should be avoided in game code.
+		 * @param source The Entity to operate on
+		 * @param area The area, usually the swept collider of the source
+		 * @param func The EntityIter callback func to use
+		 * @return The number of collidables rejected by the collision filter
+		 */
+		size_t iterateCollidablesOverlapping(const Entity* source,
+		                                     const EntityShape& area,
+		                                     EntityIter func);
 
 		/**
 		 * Check all collidables with the provided EntityProcessor.
@@ -246,6 +595,84 @@ namespace flat2d {
 		 */
 		Entity* checkCollidablesFor(const Entity*, EntityProcessor);
 
+		/**
+		 * Find all collidables overlapping a rectangle. Uses the spatial
+		 * partitions and doesn't allocate.
+		 * @param area The rectangle to check
+		 * @param result A caller supplied buffer for the result
+		 * @param capacity The size of the result buffer
+		 * @return The number of Entity objects written to result
+		 */
+		size_t queryRect(const EntityShape& area,
+		                 Entity** result,
+		                 size_t capacity);
+
+		/**
+		 * Find all collidables overlapping a circle. Uses the spatial
+		 * partitions and doesn't allocate.
+		 * @param x The circle center x position
+		 * @param y The circle center y position
+		 * @param radius The circle radius
+		 * @param result A caller supplied buffer for the result
+		 * @param capacity The size of the result buffer
+		 * @return The number of Entity objects written to result
+		 */
+		size_t queryCircle(int x,
+		                   int y,
+		                   int radius,
+		                   Entity** result,
+		                   size_t capacity);
+
+		/**
+		 * Cast a ray between two points and find the first collidable it
+		 * hits. Uses the spatial partitions and doesn't allocate.
+		 * @param x1 The ray start x position
+		 * @param y1 The ray start y position
+		 * @param x2 The ray end x position
+		 * @param y2 The ray end y position
+		 * @param hit Set to the first hit if there is one
+		 * @return true if the ray hit something
+		 */
+		bool raycast(int x1, int y1, int x2, int y2, RayHit* hit);
+
+		/**
+		 * Cast a ray between two points and find every collidable it hits.
+		 * The hits are sorted on distance and if there are more hits than
+		 * the buffer can hold the closest are kept. Uses the spatial
+		 * partitions and doesn't allocate.
+		 * @param x1 The ray start x position
+		 * @param y1 The ray start y position
+		 * @param x2 The ray end x position
+		 * @param y2 The ray end y position
+		 * @param hits A caller supplied buffer for the hits
+		 * @param capacity The size of the hits buffer
+		 * @return The number of hits written to hits
+		 */
+		size_t raycastAll(int x1,
+		                  int y1,
+		                  int x2,
+		                  int y2,
+		                  RayHit* hits,
+		                  size_t capacity);
+
+		/**
+		 * Find the collidables closest to a point. The distance is measured
+		 * to the closest point of each collider. Uses the spatial partitions
+		 * and doesn't allocate.
+		 * @param x The x position
+		 * @param y The y position
+		 * @param maxDistance Ignore collidables further away than this
+		 * @param result A caller supplied buffer for the result
+		 * @param k The number of Entity objects to find, the size of result
+		 * @return The number of Entity objects written to result, closest
+		 * first
+		 */
+		size_t queryNearest(int x,
+		                    int y,
+		                    int maxDistance,
+		                    Entity** result,
+		                    size_t k);
+
 		/**
 		 * Remove a rendering area from the EntityContainer
 		 * @param key The key identifier for the area to remove
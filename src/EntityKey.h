@@ -0,0 +1,46 @@
+#ifndef ENTITYKEY_H_
+#define ENTITYKEY_H_
+
+#include <SDL.h>
+#include <functional>
+
+namespace flat2d {
+	/**
+	 * The identity of an Entity as used by the containers. Keys are
+	 * created from the sequential Entity ids so ordering keys orders
+	 * Entity objects by creation.
+	 */
+	struct EntityKey
+	{
+		Uint64 value;
+
+		EntityKey()
+		  : value(0)
+		{}
+
+		explicit EntityKey(Uint64 v)
+		  : value(v)
+		{}
+
+		bool operator==(const EntityKey& o) const { return value == o.value; }
+
+		bool operator!=(const EntityKey& o) const { return value != o.value; }
+
+		bool operator<(const EntityKey& o) const { return value < o.value; }
+	};
+} // namespace flat2d
+
+namespace std {
+	template<>
+	struct hash<flat2d::EntityKey>
+	{
+		size_t operator()(const flat2d::EntityKey& key) const
+		{
+			// Spread the sequential ids over the buckets
+			Uint64 h = key.value * 0x9E3779B97F4A7C15ULL;
+			return static_cast<size_t>(h ^ (h >> 32));
+		}
+	};
+} // namespace std
+
+#endif // ENTITYKEY_H_
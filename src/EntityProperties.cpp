@@ -79,6 +79,47 @@ namespace flat2d {
 
 	bool EntityProperties::isCollidable() const { return collidable; }
 
+	void EntityProperties::setStatic(bool isStatic) { staticBody = isStatic; }
+
+	bool EntityProperties::isStatic() const { return staticBody; }
+
+	void EntityProperties::setContinuousCollision(bool continuous)
+	{
+		continuousCollision = continuous;
+	}
+
+	bool EntityProperties::hasContinuousCollision() const
+	{
+		return continuousCollision;
+	}
+
+	void EntityProperties::setTrigger(bool trigger) { this->trigger = trigger; }
+
+	bool EntityProperties::isTrigger() const { return trigger; }
+
+	void EntityProperties::setCollisionCategory(Uint32 category)
+	{
+		collisionCategory = category;
+	}
+
+	Uint32 EntityProperties::getCollisionCategory() const
+	{
+		return collisionCategory;
+	}
+
+	void EntityProperties::setCollisionMask(Uint32 mask)
+	{
+		collisionMask = mask;
+	}
+
+	Uint32 EntityProperties::getCollisionMask() const { return collisionMask; }
+
+	bool EntityProperties::canCollideWith(const EntityProperties& other) const
+	{
+		return (collisionCategory & other.collisionMask) != 0 &&
+		       (other.collisionCategory & collisionMask) != 0;
+	}
+
 	void EntityProperties::setVisible(bool visible) { this->visible = visible; }
 
 	bool EntityProperties::isVisible() const { return visible; }
@@ -165,6 +206,9 @@ namespace flat2d {
 	void EntityProperties::setLocationChanged(bool changed)
 	{
 		locationChanged = changed;
+		if (changed) {
+			wake();
+		}
 	}
 
 	bool EntityProperties::hasLocationChanged() const
@@ -172,6 +216,35 @@ namespace flat2d {
 		return locationChanged;
 	}
 
+	void EntityProperties::wake()
+	{
+		idleFrames = 0;
+		if (!sleeping) {
+			return;
+		}
+
+		sleeping = false;
+		if (wakeCallback) {
+			wakeCallback();
+		}
+	}
+
+	bool EntityProperties::isSleeping() const { return sleeping; }
+
+	void EntityProperties::setSleeping(bool sleep) { sleeping = sleep; }
+
+	unsigned int EntityProperties::incrementIdleFrames()
+	{
+		return ++idleFrames;
+	}
+
+	unsigned int EntityProperties::getIdleFrames() const { return idleFrames; }
+
+	void EntityProperties::setWakeCallback(const WakeCallback& callback)
+	{
+		wakeCallback = callback;
+	}
+
 	EntityProperties::Areas& EntityProperties::getCurrentAreas()
 	{
 		return currentAreas;
@@ -22,8 +22,11 @@ namespace flat2d {
 	 */
 	class EntityProperties : public Square
 	{
+		friend class EntityContainer;
+
 	  public:
 		typedef std::vector<MapArea> Areas;
+		typedef std::function<void()> WakeCallback;
 
 	  private:
 		int z = 0;
@@ -32,13 +35,22 @@ namespace flat2d {
 		float yvel = 0.0f;
 
 		bool collidable = false;
+		bool staticBody = false;
+		bool continuousCollision = false;
+		bool trigger = false;
 		bool locationChanged = false;
 		bool visible = true;
+		bool sleeping = false;
+		unsigned int idleFrames = 0;
+		unsigned int queryStamp = 0;
+		Uint32 collisionCategory = 0x1;
+		Uint32 collisionMask = 0xFFFFFFFF;
 
 		CollisionProperty collisionProperty = CollisionProperty::SOLID;
 
 		EntityShape colliderShape = { 0, 0, 0, 0 };
 		Areas currentAreas;
+		WakeCallback wakeCallback = nullptr;
 
 		EntityShape getCustomVelocityColliderShape(float dx, float dy) const;
 
@@ -117,6 +129,94 @@ namespace flat2d {
 		 */
 		bool isCollidable() const;
 
+		/**
+		 * Mark this Entity as a static body. Static bodies are immovable
+		 * collidable geometry (walls, floors etc). They are kept in a
+		 * separate spatial index that is built once and they are never
+		 * re-partitioned or checked against other static bodies. Velocity
+		 * has no effect on a static body. Set this before registering the
+		 * Entity or call EntityContainer::repopulateCollidables after.
+		 * @param isStatic true or false
+		 */
+		void setStatic(bool isStatic);
+
+		/**
+		 * Check if the Entity is a static body
+		 * @return true or false
+		 */
+		bool isStatic() const;
+
+		/**
+		 * Enable continuous collision detection for this Entity. Fast
+		 * moving bodies (projectiles etc) can tunnel through thin objects
+		 * with the default collision detection. Continuous bodies are swept
+		 * against other collidables and sub stepped when they move fast. It
+		 * costs more so only enable it where it's needed.
+		 * @param continuous true or false
+		 */
+		void setContinuousCollision(bool continuous);
+
+		/**
+		 * Check if the Entity uses continuous collision detection
+		 * @return true or false
+		 */
+		bool hasContinuousCollision() const;
+
+		/**
+		 * Mark this Entity as a trigger. Triggers (pickups, zones etc) are
+		 * kept in a separate spatial index and never take part in
+		 * collision resolution. Awake collidable bodies that overlap a
+		 * trigger, and pass the collision category and mask check, produce
+		 * trigger contacts in the ContactManager instead. Set this before
+		 * registering the Entity or call
+		 * EntityContainer::repopulateCollidables after.
+		 * @param trigger true or false
+		 */
+		void setTrigger(bool trigger);
+
+		/**
+		 * Check if the Entity is a trigger
+		 * @return true or false
+		 */
+		bool isTrigger() const;
+
+		/**
+		 * Set the collision category bits of this Entity. Usually a single
+		 * bit identifying what kind of body this is (player, bullet, wall
+		 * etc). Defaults to 0x1.
+		 * @param category The category bits
+		 */
+		void setCollisionCategory(Uint32 category);
+
+		/**
+		 * Get the collision category bits of this Entity
+		 * @return The category bits
+		 */
+		Uint32 getCollisionCategory() const;
+
+		/**
+		 * Set the collision mask of this Entity. Two entities only collide
+		 * if the category of each one is in the mask of the other. Filtered
+		 * pairs never reach the collision tests or the onCollision callbacks.
+		 * Defaults to 0xFFFFFFFF (collide with everything).
+		 * @param mask The mask bits
+		 */
+		void setCollisionMask(Uint32 mask);
+
+		/**
+		 * Get the collision mask of this Entity
+		 * @return The mask bits
+		 */
+		Uint32 getCollisionMask() const;
+
+		/**
+		 * Check if the category and mask of this Entity and another allows
+		 * them to collide
+		 * @param other The other EntityProperties
+		 * @return true or false
+		 */
+		bool canCollideWith(const EntityProperties& other) const;
+
 		/**
 		 * Mark this Entity as visible (will render)
 		 * @param visible true or false
@@ -266,6 +366,47 @@ namespace flat2d {
 		 * @return true or false
 		 */
 		bool hasLocationChanged() const;
+
+		/**
+		 * Wake the Entity if it's sleeping and reset its idle counter.
+		 * Sleeping Entities are woken automatically on collisions, velocity
+		 * and position changes. Call this if you need your Entity to receive
+		 * move callbacks for some other reason.
+		 */
+		void wake();
+
+		/**
+		 * Check if the Entity is sleeping. Sleeping Entities don't receive
+		 * move callbacks.
+		 * @return true or false
+		 */
+		bool isSleeping() const;
+
+		/**
+		 * Put the Entity to sleep or mark it as awake without triggering the
+		 * wake callback. Used by engine.
+		 * @param sleep true or false
+		 */
+		void setSleeping(bool sleep);
+
+		/**
+		 * Count another frame where the Entity didn't move. Used by engine.
+		 * @return The number of consecutive idle frames
+		 */
+		unsigned int incrementIdleFrames();
+
+		/**
+		 * Get the number of consecutive frames the Entity has been idle
+		 * @return an unsigned int value
+		 */
+		unsigned int getIdleFrames() const;
+
+		/**
+		 * Set the callback triggered when a sleeping Entity is woken.
+		 * Used by engine.
+		 * @param callback The WakeCallback
+		 */
+		void setWakeCallback(const WakeCallback& callback);
 	};
 } // namespace flat2d
 
@@ -11,8 +11,10 @@
 #include "GameControllerContainer.h"
 #include "GameData.h"
 #include "GameEngine.h"
+#include "JobPool.h"
 #include "Mixer.h"
 #include "RenderData.h"
+#include "TaskScheduler.h"
 #include "Window.h"
 
 namespace flat2d {
@@ -23,6 +25,8 @@ namespace flat2d {
 		delete gameData;
 		delete collisionDetector;
 		delete entityContainer;
+		delete jobPool;
+		delete taskScheduler;
 		delete window;
 		delete camera;
 		delete mixer;
@@ -96,6 +100,8 @@ namespace flat2d {
 	{
 		deltatimeMonitor = new DeltatimeMonitor();
 		entityContainer = new EntityContainer(deltatimeMonitor);
+		jobPool = new JobPool();
+		entityContainer->setJobPool(jobPool);
 		collisionDetector =
 		  new CollisionDetector(entityContainer, deltatimeMonitor);
 		renderData = new RenderData(window->getRenderer(), camera);
@@ -106,6 +112,9 @@ namespace flat2d {
 		                        mixer,
 		                        renderData,
 		                        deltatimeMonitor);
+		gameData->setJobPool(jobPool);
+		taskScheduler = new TaskScheduler();
+		gameData->setTaskScheduler(taskScheduler);
 		gameEngine = new GameEngine(gameData);
 
 		return true;
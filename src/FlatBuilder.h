@@ -14,6 +14,8 @@ namespace flat2d {
 	class DeltatimeMonitor;
 	class GameControllerContainer;
 	class GameEngine;
+	class JobPool;
+	class TaskScheduler;
 
 	/**
 	 * This is the main builder for the flat library. It is responsible
@@ -32,6 +34,8 @@ namespace flat2d {
 		DeltatimeMonitor* deltatimeMonitor = nullptr;
 		GameControllerContainer* controllerContainer = nullptr;
 		GameEngine* gameEngine = nullptr;
+		JobPool* jobPool = nullptr;
+		TaskScheduler* taskScheduler = nullptr;
 
 		bool hidpi = false;
 
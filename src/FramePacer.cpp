@@ -0,0 +1,213 @@
+#include "FramePacer.h"
+#include "SpinLock.h"
+
+namespace flat2d {
+	static Uint64 performanceCounter() { return SDL_GetPerformanceCounter(); }
+
+	FramePacer::FramePacer()
+	  : clock(performanceCounter)
+	  , frequency(SDL_GetPerformanceFrequency())
+	  , frameStart(clock())
+	  , lastFrame(frameStart)
+	{}
+
+	void FramePacer::setClock(Clock clock, Uint64 frequency)
+	{
+		if (clock == nullptr || frequency == 0) {
+			clock = performanceCounter;
+			frequency = SDL_GetPerformanceFrequency();
+		}
+		this->clock = clock;
+		this->frequency = frequency;
+		start();
+	}
+
+	void FramePacer::setRenderer(SDL_Renderer* renderer)
+	{
+		this->renderer = renderer;
+		vsyncActive = readVsync();
+		refreshRate = readRefreshRate();
+		if (vsyncActive) {
+			// Leave the vsync the renderer was created with alone
+			mode = PACING_VSYNC;
+		}
+	}
+
+	void FramePacer::setMode(PacingMode mode)
+	{
+		this->mode = mode;
+		applyVsync();
+	}
+
+	PacingMode FramePacer::getMode() const { return mode; }
+
+	bool FramePacer::isVsyncActive() const { return vsyncActive; }
+
+	bool FramePacer::readVsync() const
+	{
+		SDL_RendererInfo info;
+		return renderer != nullptr &&
+		       SDL_GetRendererInfo(renderer, &info) == 0 &&
+		       (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+	}
+
+	double FramePacer::readRefreshRate() const
+	{
+		if (renderer == nullptr) {
+			return 0.0;
+		}
+		SDL_Window* window = SDL_RenderGetWindow(renderer);
+		if (window == nullptr) {
+			return 0.0;
+		}
+
+		// A refresh rate of 0 means the display didn't report one
+		SDL_DisplayMode displayMode;
+		int display = SDL_GetWindowDisplayIndex(window);
+		if (display < 0 ||
+		    SDL_GetCurrentDisplayMode(display, &displayMode) != 0) {
+			return 0.0;
+		}
+		return displayMode.refresh_rate;
+	}
+
+	void FramePacer::applyVsync()
+	{
+		if (renderer == nullptr) {
+			vsyncActive = false;
+			return;
+		}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		if (SDL_RenderSetVSync(renderer, mode == PACING_VSYNC ? 1 : 0) == 0) {
+			vsyncActive = mode == PACING_VSYNC;
+			return;
+		}
+#endif
+		// Vsync is fixed when the renderer is created
+		vsyncActive = readVsync();
+	}
+
+	void FramePacer::setTargetFps(double fps)
+	{
+		targetFps = fps > 0.0 ? fps : 60.0;
+	}
+
+	double FramePacer::getTargetFps() const { return targetFps; }
+
+	void FramePacer::setRefreshRate(double hz)
+	{
+		refreshRate = hz > 0.0 ? hz : 0.0;
+	}
+
+	double FramePacer::getRefreshRate() const { return refreshRate; }
+
+	void FramePacer::setSpinThreshold(float milliseconds)
+	{
+		spinThreshold = milliseconds > 0.0f ? milliseconds : 0.0f;
+	}
+
+	Uint64 FramePacer::getPeriod(float speed) const
+	{
+		if (mode == PACING_UNCAPPED || speed <= 0.0f) {
+			return 0;
+		}
+		return static_cast<Uint64>(frequency / (targetFps * speed));
+	}
+
+	Uint64 FramePacer::getRefreshPeriod() const
+	{
+		double rate = refreshRate > 0.0 ? refreshRate : targetFps;
+		return static_cast<Uint64>(frequency / rate);
+	}
+
+	float FramePacer::getRemainingTime(float speed) const
+	{
+		// With vsync the frame started when the last present returned,
+		// right after a refresh, so the deadline is the next refresh
+		Uint64 period = getPeriod(speed);
+		if (vsyncActive && period != 0) {
+			period = getRefreshPeriod();
+		}
+		Uint64 now = clock();
+		if (period == 0 || now >= frameStart + period) {
+			return 0.0f;
+		}
+		return (frameStart + period - now) * 1000.0f / frequency;
+	}
+
+	void FramePacer::waitUntil(Uint64 target) const
+	{
+		Uint64 now = clock();
+		if (now >= target) {
+			return;
+		}
+
+		// SDL_Delay oversleeps, leave the last part to the spin
+		float remaining = (target - now) * 1000.0f / frequency;
+		if (remaining > spinThreshold) {
+			SDL_Delay(static_cast<Uint32>(remaining - spinThreshold));
+		}
+		while (clock() < target) {
+			FLAT_CPU_RELAX();
+		}
+	}
+
+	void FramePacer::start()
+	{
+		frameStart = clock();
+		lastFrame = frameStart;
+	}
+
+	void FramePacer::waitForNextFrame(float speed)
+	{
+		Uint64 period = getPeriod(speed);
+		Uint64 deadline = frameStart + period;
+		Uint64 finished = clock();
+		// Present already waits for the refresh with vsync, pacing on top
+		// of it would judder
+		bool paced = period != 0 && !vsyncActive;
+
+		if (paced) {
+			if (finished > deadline) {
+				stats.missedDeadlines++;
+				float lateness = (finished - deadline) * 1000.0f / frequency;
+				if (lateness > stats.worstLateness) {
+					stats.worstLateness = lateness;
+				}
+			}
+			waitUntil(deadline);
+		} else if (period != 0 && vsyncActive) {
+			// Present skipped a refresh, the target frame rate doesn't
+			// matter here
+			Uint64 refresh = getRefreshPeriod();
+			if (finished - lastFrame > refresh + refresh / 2) {
+				stats.missedDeadlines++;
+				float lateness =
+				  (finished - lastFrame - refresh) * 1000.0f / frequency;
+				if (lateness > stats.worstLateness) {
+					stats.worstLateness = lateness;
+				}
+			}
+		}
+
+		Uint64 now = clock();
+		stats.frames++;
+		stats.lastFrameTime = (now - lastFrame) * 1000.0f / frequency;
+		stats.averageFrameTime +=
+		  (stats.lastFrameTime - stats.averageFrameTime) / stats.frames;
+		lastFrame = now;
+
+		// Keep to the schedule so sleep errors don't accumulate, unless
+		// the frame was so late that catching up would rush frames
+		if (paced && now - deadline < period) {
+			frameStart = deadline;
+		} else {
+			frameStart = now;
+		}
+	}
+
+	const PacingStats& FramePacer::getStats() const { return stats; }
+
+	void FramePacer::resetStats() { stats = PacingStats(); }
+} // namespace flat2d
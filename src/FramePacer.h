@@ -0,0 +1,176 @@
+#ifndef FRAMEPACER_H_
+#define FRAMEPACER_H_
+
+#include <SDL.h>
+
+namespace flat2d {
+	/**
+	 * How the FramePacer paces frames
+	 */
+	enum PacingMode
+	{
+		PACING_VSYNC,   // Present blocks on the display refresh
+		PACING_CAPPED,  // The FramePacer waits for the target frame rate
+		PACING_UNCAPPED // Frames run back to back
+	};
+
+	/**
+	 * Frame timing statistics collected by the FramePacer
+	 */
+	struct PacingStats
+	{
+		Uint64 frames = 0;
+		Uint64 missedDeadlines = 0;
+		float lastFrameTime = 0.0f;
+		float averageFrameTime = 0.0f;
+		float worstLateness = 0.0f;
+	};
+
+	/**
+	 * Paces the game loop to a target frame rate. Frame deadlines are kept
+	 * on an absolute schedule from the high resolution performance counter
+	 * so sleep inaccuracies don't add up over time. Waiting sleeps until
+	 * shortly before the deadline and spins for the rest.
+	 *
+	 * A frame finishing after its deadline counts as missed. If it's late
+	 * by more than a frame the schedule restarts from the current time
+	 * instead of rushing frames to catch up.
+	 */
+	class FramePacer
+	{
+	  public:
+		typedef Uint64 (*Clock)();
+
+	  private:
+		PacingMode mode = PACING_CAPPED;
+		SDL_Renderer* renderer = nullptr;
+		bool vsyncActive = false;
+		double targetFps = 60.0;
+		double refreshRate = 0.0;
+		float spinThreshold = 2.0f;
+		Clock clock;
+		Uint64 frequency;
+		Uint64 frameStart;
+		Uint64 lastFrame;
+		PacingStats stats;
+
+		Uint64 getPeriod(float speed) const;
+		Uint64 getRefreshPeriod() const;
+		bool readVsync() const;
+		double readRefreshRate() const;
+		void applyVsync();
+		void waitUntil(Uint64 target) const;
+
+	  public:
+		FramePacer();
+
+		/**
+		 * Replace the high resolution performance counter the frames are
+		 * timed with. Meant for tests driving the pacer with a fake clock.
+		 * Restarts the current frame.
+		 * @param clock The clock or nullptr for the performance counter
+		 * @param frequency The clock ticks per second
+		 */
+		void setClock(Clock clock, Uint64 frequency);
+
+		/**
+		 * Set the renderer whose vsync the pacing mode controls. The vsync
+		 * state is read from the renderer and left as is, a renderer
+		 * created with vsync switches the FramePacer to the VSYNC mode.
+		 * @param renderer The SDL_Renderer or nullptr
+		 */
+		void setRenderer(SDL_Renderer* renderer);
+
+		/**
+		 * Set the pacing mode. It can be changed while the game runs.
+		 * From SDL 2.0.18 the renderer vsync is switched on for the VSYNC
+		 * mode and off for the others. Without runtime vsync control the
+		 * vsync the renderer was created with is kept: VSYNC falls back to
+		 * CAPPED without it, and the other modes don't wait with it.
+		 * @param mode The PacingMode
+		 */
+		void setMode(PacingMode mode);
+
+		/**
+		 * Get the pacing mode
+		 * @return The PacingMode
+		 */
+		PacingMode getMode() const;
+
+		/**
+		 * Check if present is synchronized with the display
+		 * @return true or false
+		 */
+		bool isVsyncActive() const;
+
+		/**
+		 * Set the target frame rate
+		 * @param fps The frames per second
+		 */
+		void setTargetFps(double fps);
+
+		/**
+		 * Get the target frame rate
+		 * @return The frames per second
+		 */
+		double getTargetFps() const;
+
+		/**
+		 * Set the display refresh rate used to time frames with active
+		 * vsync. It's read from the display mode when the renderer is set,
+		 * override it if the display doesn't report one. With 0 the target
+		 * frame rate is used instead.
+		 * @param hz The refresh rate
+		 */
+		void setRefreshRate(double hz);
+
+		/**
+		 * Get the display refresh rate
+		 * @return The refresh rate, 0 if unknown
+		 */
+		double getRefreshRate() const;
+
+		/**
+		 * Set how long before the deadline the FramePacer stops sleeping
+		 * and starts spinning. Raise it on systems with coarse sleeps.
+		 * Defaults to 2 milliseconds.
+		 * @param milliseconds The spin threshold
+		 */
+		void setSpinThreshold(float milliseconds);
+
+		/**
+		 * Get the time left until the current frame deadline. With active
+		 * vsync the deadline is estimated as one display refresh after
+		 * the last present returned. There is no deadline when uncapped.
+		 * @param speed The frame rate multiplier, 0 means no deadline
+		 * @return The remaining time in milliseconds, 0 if late or unknown
+		 */
+		float getRemainingTime(float speed = 1.0f) const;
+
+		/**
+		 * Start the first frame now. Call it when the game loop starts so
+		 * the time spent loading doesn't count as a missed deadline.
+		 */
+		void start();
+
+		/**
+		 * Wait for the deadline of the current frame and start the next
+		 * one. Call it once per frame after presenting.
+		 * @param speed The frame rate multiplier, 0 runs uncapped
+		 */
+		void waitForNextFrame(float speed = 1.0f);
+
+		/**
+		 * Get the frame timing statistics, times are in milliseconds
+		 * @return The PacingStats
+		 */
+		const PacingStats& getStats() const;
+
+		/**
+		 * Reset the frame timing statistics
+		 */
+		void resetStats();
+	};
+} // namespace flat2d
+
+#endif // FRAMEPACER_H_
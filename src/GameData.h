@@ -8,6 +8,9 @@ namespace flat2d {
 	class Mixer;
 	class Camera;
 	class DeltatimeMonitor;
+	class ComponentRegistry;
+	class JobPool;
+	class TaskScheduler;
 
 	/**
 	 * The GameData object acts as a container for the game and it's state.
@@ -23,6 +26,9 @@ namespace flat2d {
 		RenderData* renderData;
 		DeltatimeMonitor* deltatimeMonitor;
 		void* customGameData = nullptr;
+		ComponentRegistry* componentRegistry = nullptr;
+		JobPool* jobPool = nullptr;
+		TaskScheduler* taskScheduler = nullptr;
 
 	  public:
 		GameData(EntityContainer* obc,
@@ -78,6 +84,54 @@ namespace flat2d {
 		 */
 		void* getCustomGameData() const { return customGameData; }
 
+		/**
+		 * Store a ComponentRegistry with the GameData so systems can reach
+		 * it. It's not destroyed with the GameData object.
+		 */
+		void setComponentRegistry(ComponentRegistry* registry)
+		{
+			componentRegistry = registry;
+		}
+
+		/**
+		 * Get the ComponentRegistry
+		 *
+		 * @return A ComponentRegistry pointer or nullptr
+		 */
+		ComponentRegistry* getComponentRegistry() const
+		{
+			return componentRegistry;
+		}
+
+		/**
+		 * Store the JobPool so game code can run loading work on it. It's
+		 * not destroyed with the GameData object.
+		 */
+		void setJobPool(JobPool* pool) { jobPool = pool; }
+
+		/**
+		 * Get the JobPool
+		 *
+		 * @return A JobPool pointer or nullptr
+		 */
+		JobPool* getJobPool() const { return jobPool; }
+
+		/**
+		 * Store the TaskScheduler the GameEngine runs in the frame slack.
+		 * It's not destroyed with the GameData object.
+		 */
+		void setTaskScheduler(TaskScheduler* scheduler)
+		{
+			taskScheduler = scheduler;
+		}
+
+		/**
+		 * Get the TaskScheduler
+		 *
+		 * @return A TaskScheduler pointer or nullptr
+		 */
+		TaskScheduler* getTaskScheduler() const { return taskScheduler; }
+
 		/**
 		 * Get the DeltatimeMonitor object pointer
 		 *
@@ -1,80 +1,192 @@
 #include <SDL.h>
 #include <SDL_ttf.h>
 
+#include "Animation.h"
 #include "DeltatimeMonitor.h"
 #include "EntityContainer.h"
 #include "GameData.h"
 #include "GameEngine.h"
+#include "InputRecorder.h"
 #include "RenderData.h"
-#include "Timer.h"
+#include "TaskScheduler.h"
 
 namespace flat2d {
 	void GameEngine::init(int fps)
 	{
 		int nfps = fps > 0 ? fps : 60;
-		this->screenTicksPerFrame = 1000 / nfps;
+		framePacer.setTargetFps(nfps);
+		if (gameData->getRenderData() != nullptr) {
+			framePacer.setRenderer(gameData->getRenderData()->getRenderer());
+		}
+	}
+
+	void GameEngine::setInputRecorder(InputRecorder* recorder)
+	{
+		inputRecorder = recorder;
+	}
+
+	FramePacer* GameEngine::getFramePacer() { return &framePacer; }
+
+	bool GameEngine::pollEvent(SDL_Event* event) const
+	{
+		if (inputRecorder != nullptr &&
+		    inputRecorder->getMode() == InputRecorder::PLAYBACK) {
+			// Keep the window responsive but only let quit through
+			SDL_Event live;
+			while (SDL_PollEvent(&live) != 0) {
+				if (live.type == SDL_QUIT) {
+					*event = live;
+					return true;
+				}
+			}
+			return inputRecorder->pollEvent(event);
+		}
+
+		if (SDL_PollEvent(event) == 0) {
+			return false;
+		}
+		if (inputRecorder != nullptr) {
+			inputRecorder->recordEvent(*event);
+		}
+		return true;
+	}
+
+	void GameEngine::dispatchEvent(const SDL_Event& event,
+	                               const HandleCallback& handleCallback) const
+	{
+		if (handleCallback) {
+			handleCallback(event);
+		}
+		gameData->getEntityContainer()->handleObjects(event, gameData);
+	}
+
+	float GameEngine::getPacingSpeed() const
+	{
+		if (inputRecorder == nullptr ||
+		    inputRecorder->getMode() != InputRecorder::PLAYBACK) {
+			return 1.0f;
+		}
+		return inputRecorder->getPlaybackSpeed();
+	}
+
+	unsigned int GameEngine::getTicksDue() const
+	{
+		DeltatimeMonitor* dtMonitor = gameData->getDeltatimeMonitor();
+		if (!dtMonitor->isFixedTimestep() ||
+		    (inputRecorder != nullptr &&
+		     inputRecorder->getMode() == InputRecorder::PLAYBACK)) {
+			return 1;
+		}
+		return dtMonitor->collectTicks();
 	}
 
 	void GameEngine::run(StateCallback stateCallback,
-	                     HandleCallback handleCallback) const
+	                     HandleCallback handleCallback)
 	{
 		SDL_Renderer* renderer = gameData->getRenderData()->getRenderer();
 		EntityContainer* entityContainer = gameData->getEntityContainer();
+		DeltatimeMonitor* dtMonitor = gameData->getDeltatimeMonitor();
 
 		// Loop stuff
-		flat2d::Timer fpsCapTimer;
 		SDL_Event e;
 		bool quit = false;
+		bool ended = false;
 
-		// Main loop
-		gameData->getDeltatimeMonitor()->updateDeltaTime();
+		// Main loop, a fixed timestep needs no priming
+		if (!dtMonitor->isFixedTimestep()) {
+			dtMonitor->updateDeltaTime();
+		}
+		framePacer.start();
 		while (!quit) {
-			fpsCapTimer.start();
-			gameData->getDeltatimeMonitor()->updateDeltaTime();
+			// A fixed timestep runs as many ticks as the frame took
+			unsigned int ticks = getTicksDue();
+			bool reset = false;
+			for (unsigned int tick = 0; tick < ticks && !quit; tick++) {
+				dtMonitor->updateDeltaTime();
+				if (inputRecorder != nullptr &&
+				    !inputRecorder->beginTick(dtMonitor)) {
+					// The playback has ended
+					ended = true;
+					break;
+				}
+				AnimationClock::advance(dtMonitor->getDeltaTime());
 
-			if (stateCallback) {
-				switch (stateCallback(gameData)) {
-					case RESET:
-						continue;
-					case QUIT:
-						quit = true;
-						break;
-					case NOOP:
-					default:
-						break;
+				if (stateCallback) {
+					switch (stateCallback(gameData)) {
+						case RESET:
+							reset = true;
+							break;
+						case QUIT:
+							quit = true;
+							break;
+						case NOOP:
+						default:
+							break;
+					}
+				}
+				if (reset) {
+					break;
 				}
-			}
 
-			entityContainer->initiateEntities(gameData);
+				entityContainer->initiateEntities(gameData);
 
-			// Handle events
-			while (SDL_PollEvent(&e) != 0) {
-				if (e.type == SDL_QUIT) {
-					quit = true;
-					break;
+				// Handle events, mouse motion within a tick is coalesced into
+				// one event with the latest position and the summed movement
+				SDL_Event motion;
+				bool pendingMotion = false;
+				while (pollEvent(&e)) {
+					if (e.type == SDL_MOUSEMOTION) {
+						if (pendingMotion) {
+							e.motion.xrel += motion.motion.xrel;
+							e.motion.yrel += motion.motion.yrel;
+						}
+						motion = e;
+						pendingMotion = true;
+						continue;
+					}
+					if (pendingMotion) {
+						dispatchEvent(motion, handleCallback);
+						pendingMotion = false;
+					}
+					if (e.type == SDL_QUIT) {
+						quit = true;
+						break;
+					}
+					dispatchEvent(e, handleCallback);
 				}
-				if (handleCallback) {
-					handleCallback(e);
+				if (pendingMotion) {
+					dispatchEvent(motion, handleCallback);
 				}
-				entityContainer->handleObjects(e, gameData);
-			}
 
-			entityContainer->moveObjects(gameData);
+				entityContainer->moveObjects(gameData);
+			}
+			if (ended) {
+				break;
+			}
+			if (reset) {
+				continue;
+			}
 
 			// Clear screen to black
 			SDL_SetRenderDrawColor(renderer, 0x0, 0x0, 0x0, 0xFF);
 			SDL_RenderClear(renderer);
+			gameData->getRenderData()->updateCameraTransforms();
 			entityContainer->renderObjects(gameData);
 
 			SDL_SetRenderDrawColor(renderer, 0xFF, 0x00, 0x00, 0xFF);
 
+			// Spend the slack on deferred work, before a vsynced present
+			// blocks it away
+			float speed = getPacingSpeed();
+			TaskScheduler* scheduler = gameData->getTaskScheduler();
+			if (scheduler != nullptr) {
+				scheduler->run(framePacer.getRemainingTime(speed));
+			}
+
 			// Update the screen
 			SDL_RenderPresent(renderer);
 
-			int tickCount = fpsCapTimer.getTicks();
-			if (tickCount < screenTicksPerFrame) {
-				SDL_Delay(screenTicksPerFrame - tickCount);
-			}
+			framePacer.waitForNextFrame(speed);
 		}
 	}
 } // namespace flat2d
@@ -3,10 +3,13 @@
 
 #include <functional>
 
+#include "FramePacer.h"
+
 namespace flat2d {
 	class GameData;
 	class RenderData;
 	class EntityContainer;
+	class InputRecorder;
 
 	/**
 	 * Available returns for the StateCallback
@@ -28,12 +31,19 @@ namespace flat2d {
 	{
 	  private:
 		GameData* gameData;
+		InputRecorder* inputRecorder = nullptr;
 
-		int screenTicksPerFrame = 1000 / 60;
+		FramePacer framePacer;
 
 		GameEngine(const GameEngine&);     // Don't implement
 		void operator=(const GameEngine&); // Don't implement
 
+		bool pollEvent(SDL_Event* event) const;
+		void dispatchEvent(const SDL_Event& event,
+		                   const HandleCallback& handleCallback) const;
+		float getPacingSpeed() const;
+		unsigned int getTicksDue() const;
+
 	  public:
 		/**
 		 * Construct the GameEngine
@@ -55,13 +65,30 @@ namespace flat2d {
 		 */
 		void init(int fps);
 
+		/**
+		 * Record the game input to, or play it back from, an InputRecorder.
+		 * During playback the live SDL events are ignored (apart from
+		 * SDL_QUIT) and the game loop quits when the recording ends. The
+		 * GameEngine doesn't take ownership of the recorder.
+		 * @param recorder The InputRecorder or nullptr to disable
+		 */
+		void setInputRecorder(InputRecorder* recorder);
+
+		/**
+		 * Get the FramePacer pacing the game loop. Use it to switch
+		 * between vsync, capped and uncapped frame rates while the game
+		 * runs and to read the frame timing statistics.
+		 * @return The FramePacer
+		 */
+		FramePacer* getFramePacer();
+
 		/**
 		 * Start the game loop
 		 *
 		 * @param stateCallback Optional callback to handle the game loop
 		 * @param handleCallback Optional callback to handle SDL_Events
 		 */
-		void run(StateCallback = nullptr, HandleCallback = nullptr) const;
+		void run(StateCallback = nullptr, HandleCallback = nullptr);
 	};
 } // namespace flat2d
 
@@ -0,0 +1,173 @@
+#include <cstring>
+#include <string>
+
+#include "DeltatimeMonitor.h"
+#include "InputRecorder.h"
+
+namespace flat2d {
+	static const char RECORDING_MAGIC[4] = { 'F', 'L', 'I', 'R' };
+	static const Uint32 RECORDING_VERSION = 1;
+
+	InputRecorder::~InputRecorder() { stop(); }
+
+	size_t InputRecorder::eventSize(Uint32 type)
+	{
+		// Only store the part of the event union that is in use
+		switch (type) {
+			case SDL_KEYDOWN:
+			case SDL_KEYUP:
+				return sizeof(SDL_KeyboardEvent);
+			case SDL_MOUSEMOTION:
+				return sizeof(SDL_MouseMotionEvent);
+			case SDL_MOUSEBUTTONDOWN:
+			case SDL_MOUSEBUTTONUP:
+				return sizeof(SDL_MouseButtonEvent);
+			case SDL_MOUSEWHEEL:
+				return sizeof(SDL_MouseWheelEvent);
+			case SDL_QUIT:
+				return sizeof(Uint32) * 2;
+			default:
+				return sizeof(SDL_Event);
+		}
+	}
+
+	bool InputRecorder::startRecording(const std::string& path)
+	{
+		stop();
+		file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		file.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+		file.write(reinterpret_cast<const char*>(&RECORDING_VERSION),
+		           sizeof(RECORDING_VERSION));
+		mode = RECORDING;
+		tickCount = 0;
+		return true;
+	}
+
+	bool InputRecorder::startPlayback(const std::string& path)
+	{
+		stop();
+		file.open(path, std::ios::in | std::ios::binary);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		char magic[sizeof(RECORDING_MAGIC)];
+		Uint32 version = 0;
+		file.read(magic, sizeof(magic));
+		file.read(reinterpret_cast<char*>(&version), sizeof(version));
+		if (!file ||
+		    std::memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0 ||
+		    version != RECORDING_VERSION) {
+			file.close();
+			return false;
+		}
+
+		mode = PLAYBACK;
+		tickCount = 0;
+		return true;
+	}
+
+	void InputRecorder::stop()
+	{
+		if (mode == RECORDING && tickPending) {
+			writeTick();
+		}
+		if (file.is_open()) {
+			file.close();
+		}
+		mode = OFF;
+		tickPending = false;
+		tickEvents.clear();
+		nextEvent = 0;
+	}
+
+	InputRecorder::Mode InputRecorder::getMode() const { return mode; }
+
+	void InputRecorder::setPlaybackSpeed(float speed)
+	{
+		playbackSpeed = speed > 0.0f ? speed : 0.0f;
+	}
+
+	float InputRecorder::getPlaybackSpeed() const { return playbackSpeed; }
+
+	unsigned int InputRecorder::getTickCount() const { return tickCount; }
+
+	bool InputRecorder::beginTick(DeltatimeMonitor* dtMonitor)
+	{
+		if (mode == RECORDING) {
+			// Ticks are written when complete, that is when the next begins
+			if (tickPending) {
+				writeTick();
+			}
+			tickPending = true;
+			tickDeltaTime = dtMonitor->getDeltaTime();
+			tickEvents.clear();
+			tickCount++;
+		} else if (mode == PLAYBACK) {
+			if (!readTick()) {
+				stop();
+				return false;
+			}
+			dtMonitor->injectDeltaTime(tickDeltaTime);
+			tickCount++;
+		}
+		return true;
+	}
+
+	void InputRecorder::recordEvent(const SDL_Event& event)
+	{
+		if (mode == RECORDING) {
+			tickEvents.push_back(event);
+		}
+	}
+
+	bool InputRecorder::pollEvent(SDL_Event* event)
+	{
+		if (mode != PLAYBACK || nextEvent >= tickEvents.size()) {
+			return false;
+		}
+		*event = tickEvents[nextEvent++];
+		return true;
+	}
+
+	void InputRecorder::writeTick()
+	{
+		Uint16 count = static_cast<Uint16>(tickEvents.size());
+		file.write(reinterpret_cast<const char*>(&tickDeltaTime),
+		           sizeof(tickDeltaTime));
+		file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		for (Uint16 i = 0; i < count; i++) {
+			const SDL_Event& event = tickEvents[i];
+			file.write(reinterpret_cast<const char*>(&event),
+			           eventSize(event.type));
+		}
+		tickPending = false;
+	}
+
+	bool InputRecorder::readTick()
+	{
+		Uint16 count = 0;
+		file.read(reinterpret_cast<char*>(&tickDeltaTime),
+		          sizeof(tickDeltaTime));
+		file.read(reinterpret_cast<char*>(&count), sizeof(count));
+		if (!file) {
+			return false;
+		}
+
+		tickEvents.resize(count);
+		nextEvent = 0;
+		for (Uint16 i = 0; i < count; i++) {
+			SDL_Event& event = tickEvents[i];
+			std::memset(&event, 0, sizeof(event));
+			file.read(reinterpret_cast<char*>(&event.type),
+			          sizeof(event.type));
+			file.read(reinterpret_cast<char*>(&event) + sizeof(event.type),
+			          eventSize(event.type) - sizeof(event.type));
+		}
+		return static_cast<bool>(file);
+	}
+} // namespace flat2d
@@ -0,0 +1,122 @@
+#ifndef INPUTRECORDER_H_
+#define INPUTRECORDER_H_
+
+#include <SDL.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace flat2d {
+	class DeltatimeMonitor;
+
+	/**
+	 * Records the input events and deltatimes of every game loop tick to a
+	 * compact binary file and plays them back in place of the live SDL
+	 * event queue. Playing back a recording reproduces the session exactly
+	 * as long as the game itself is deterministic. Hand it to the
+	 * GameEngine with GameEngine::setInputRecorder.
+	 *
+	 * Events carrying pointers (user events, dropped files) can't be
+	 * replayed meaningfully.
+	 */
+	class InputRecorder
+	{
+	  public:
+		enum Mode
+		{
+			OFF,
+			RECORDING,
+			PLAYBACK
+		};
+
+	  private:
+		Mode mode = OFF;
+		std::fstream file;
+		float playbackSpeed = 1.0f;
+		bool tickPending = false;
+		float tickDeltaTime = 0.0f;
+		std::vector<SDL_Event> tickEvents;
+		size_t nextEvent = 0;
+		unsigned int tickCount = 0;
+
+		void writeTick();
+		bool readTick();
+		static size_t eventSize(Uint32 type);
+
+	  public:
+		~InputRecorder();
+
+		/**
+		 * Start recording to a file. Any previous recording or playback is
+		 * stopped.
+		 * @param path The file to record to, it's overwritten
+		 * @return false if the file couldn't be opened
+		 */
+		bool startRecording(const std::string& path);
+
+		/**
+		 * Start playing back a recording. Any previous recording or
+		 * playback is stopped.
+		 * @param path The recorded file
+		 * @return false if the file couldn't be opened or isn't a recording
+		 */
+		bool startPlayback(const std::string& path);
+
+		/**
+		 * Stop recording or playback and close the file
+		 */
+		void stop();
+
+		/**
+		 * Get the current mode
+		 * @return The Mode
+		 */
+		Mode getMode() const;
+
+		/**
+		 * Set how fast playback runs compared to real time. The recorded
+		 * deltatimes are replayed as is so the simulation doesn't change,
+		 * only the frame delay of the GameEngine does. 0 runs as fast as
+		 * possible.
+		 * @param speed The playback speed, defaults to 1
+		 */
+		void setPlaybackSpeed(float speed);
+
+		/**
+		 * Get the playback speed
+		 * @return The playback speed
+		 */
+		float getPlaybackSpeed() const;
+
+		/**
+		 * Get the number of ticks recorded or played back
+		 * @return The tick count
+		 */
+		unsigned int getTickCount() const;
+
+		/**
+		 * Begin a game loop tick. When recording the deltatime is saved,
+		 * during playback the recorded deltatime is injected into the
+		 * DeltatimeMonitor. Used by the GameEngine.
+		 * @param dtMonitor The DeltatimeMonitor
+		 * @return false when playback has reached the end of the recording
+		 */
+		bool beginTick(DeltatimeMonitor* dtMonitor);
+
+		/**
+		 * Save an event to the current tick. Used by the GameEngine.
+		 * @param event The event
+		 */
+		void recordEvent(const SDL_Event& event);
+
+		/**
+		 * Get the next recorded event of the current tick during playback.
+		 * Used by the GameEngine.
+		 * @param event Set to the next event
+		 * @return false when there are no more events this tick
+		 */
+		bool pollEvent(SDL_Event* event);
+	};
+} // namespace flat2d
+
+#endif // INPUTRECORDER_H_
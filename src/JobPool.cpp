@@ -0,0 +1,95 @@
+#include <algorithm>
+
+#include "JobPool.h"
+
+namespace flat2d {
+	JobPool::JobPool(unsigned int threads)
+	{
+		if (threads == 0) {
+			unsigned int hardware = std::thread::hardware_concurrency();
+			threads = hardware > 1 ? hardware - 1 : 1;
+		}
+		for (unsigned int i = 0; i < threads; i++) {
+			workers.emplace_back(&JobPool::work, this);
+		}
+	}
+
+	JobPool::~JobPool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(jobMutex);
+			stopping = true;
+		}
+		jobAvailable.notify_all();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+	}
+
+	void JobPool::work()
+	{
+		std::unique_lock<std::mutex> guard(jobMutex);
+		while (true) {
+			jobAvailable.wait(guard,
+			                  [this]() { return stopping || !jobs.empty(); });
+			if (jobs.empty()) {
+				// Only stop once the queue is drained
+				return;
+			}
+
+			Job job = std::move(jobs.front().job);
+			jobs.pop_front();
+			runningJobs++;
+			guard.unlock();
+			job();
+			guard.lock();
+			runningJobs--;
+			if (jobs.empty() && runningJobs == 0) {
+				jobsDone.notify_all();
+			}
+		}
+	}
+
+	JobPool::JobId JobPool::submit(const Job& job)
+	{
+		JobId id;
+		{
+			std::lock_guard<std::mutex> guard(jobMutex);
+			id = nextId++;
+			jobs.push_back({ id, job });
+		}
+		jobAvailable.notify_one();
+		return id;
+	}
+
+	bool JobPool::cancel(JobId id)
+	{
+		std::unique_lock<std::mutex> guard(jobMutex);
+		auto it = std::find_if(jobs.begin(), jobs.end(), [id](const Entry& e) {
+			return e.id == id;
+		});
+		if (it == jobs.end()) {
+			return false;
+		}
+		jobs.erase(it);
+		if (jobs.empty() && runningJobs == 0) {
+			jobsDone.notify_all();
+		}
+		return true;
+	}
+
+	void JobPool::wait()
+	{
+		std::unique_lock<std::mutex> guard(jobMutex);
+		jobsDone.wait(guard,
+		              [this]() { return jobs.empty() && runningJobs == 0; });
+	}
+
+	size_t JobPool::getPendingCount()
+	{
+		std::lock_guard<std::mutex> guard(jobMutex);
+		return jobs.size() + runningJobs;
+	}
+
+	size_t JobPool::getThreadCount() const { return workers.size(); }
+} // namespace flat2d
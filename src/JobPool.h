@@ -0,0 +1,91 @@
+#ifndef JOBPOOL_H_
+#define JOBPOOL_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace flat2d {
+	/**
+	 * A fixed set of worker threads running submitted jobs in the order
+	 * they were submitted. Jobs must not touch the renderer or other SDL
+	 * state bound to the main thread.
+	 */
+	class JobPool
+	{
+	  public:
+		typedef std::function<void()> Job;
+		typedef size_t JobId;
+
+	  private:
+		struct Entry
+		{
+			JobId id;
+			Job job;
+		};
+
+		std::vector<std::thread> workers;
+		std::deque<Entry> jobs;
+		JobId nextId = 1;
+		std::mutex jobMutex;
+		std::condition_variable jobAvailable;
+		std::condition_variable jobsDone;
+		size_t runningJobs = 0;
+		bool stopping = false;
+
+		JobPool(const JobPool&);        // Don't implement
+		void operator=(const JobPool&); // Don't implement
+
+		void work();
+
+	  public:
+		/**
+		 * Start the worker threads
+		 * @param threads The number of workers, 0 uses one less than the
+		 *                number of hardware threads (and at least one)
+		 */
+		explicit JobPool(unsigned int threads = 0);
+
+		/**
+		 * Run the queued jobs to completion and join the workers
+		 */
+		~JobPool();
+
+		/**
+		 * Queue a job to run on a worker thread
+		 * @param job The job
+		 * @return The JobId
+		 */
+		JobId submit(const Job& job);
+
+		/**
+		 * Remove a job that hasn't started yet
+		 * @param id The JobId
+		 * @return true if the job was still queued and won't run
+		 */
+		bool cancel(JobId id);
+
+		/**
+		 * Block until every submitted job has finished
+		 */
+		void wait();
+
+		/**
+		 * Get the number of jobs queued or running
+		 * @return The number of unfinished jobs
+		 */
+		size_t getPendingCount();
+
+		/**
+		 * Get the number of worker threads
+		 * @return The thread count
+		 */
+		size_t getThreadCount() const;
+	};
+} // namespace flat2d
+
+#endif // JOBPOOL_H_
@@ -1,6 +1,8 @@
 #ifndef MAPAREA_H_
 #define MAPAREA_H_
 
+#include <SDL.h>
+
 #include "EntityShape.h"
 #include "Square.h"
 
@@ -29,6 +31,21 @@ namespace flat2d {
 		SDL_Rect asSDLRect() const { return { x, y, w, h }; }
 
 		EntityShape asEntityShape() const { return { x, y, w, h }; }
+
+		/**
+		 * Get the spatial partition area containing a point
+		 * @param px The x position
+		 * @param py The y position
+		 * @param dim The spatial partition dimension
+		 * @return The MapArea of the partition
+		 */
+		static MapArea partitionFor(int px, int py, unsigned int dim)
+		{
+			int d = static_cast<int>(dim);
+			int xcord = px - (((px % d) + d) % d);
+			int ycord = py - (((py % d) + d) % d);
+			return MapArea(xcord, ycord, d);
+		}
 	};
 } // namespace flat2d
 
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <vector>
+
+#include "GameData.h"
+#include "Panel.h"
+#include "RenderData.h"
+
+namespace flat2d {
+	namespace ui {
+		Panel::Panel(int x, int y, unsigned int w, unsigned int h)
+		  : Entity(x, y, w, h)
+		{
+			entityProperties.setCollidable(false);
+			setFixedPosition(true);
+			subscribeEvent(SDL_MOUSEMOTION);
+			subscribeEvent(SDL_MOUSEBUTTONDOWN);
+			subscribeEvent(SDL_MOUSEBUTTONUP);
+		}
+
+		Panel::~Panel()
+		{
+			for (auto widget : widgets) {
+				delete widget;
+			}
+			if (cache != nullptr) {
+				SDL_DestroyTexture(cache);
+			}
+		}
+
+		void Panel::addWidget(Entity* widget)
+		{
+			widget->setFixedPosition(true);
+			widgets.push_back(widget);
+			invalidate(getWidgetBounds(widget));
+		}
+
+		void Panel::removeWidget(Entity* widget)
+		{
+			auto it = std::find(widgets.begin(), widgets.end(), widget);
+			if (it == widgets.end()) {
+				return;
+			}
+
+			widgets.erase(it);
+			if (hovered == widget) {
+				hovered = nullptr;
+			}
+			invalidate(getWidgetBounds(widget));
+		}
+
+		size_t Panel::getWidgetCount() const { return widgets.size(); }
+
+		SDL_Rect Panel::getWidgetBounds(const Entity* widget) const
+		{
+			return widget->getEntityProperties().getBoundingBox();
+		}
+
+		void Panel::buildGrid()
+		{
+			gridWidth =
+			  (entityProperties.getWidth() + CELL_SIZE - 1) / CELL_SIZE;
+			gridHeight =
+			  (entityProperties.getHeight() + CELL_SIZE - 1) / CELL_SIZE;
+			cells.resize(gridWidth * gridHeight);
+			for (auto& cell : cells) {
+				cell.clear();
+			}
+
+			// Add the widgets, in order, to every cell they cover
+			for (auto widget : widgets) {
+				SDL_Rect bounds = getWidgetBounds(widget);
+				if (bounds.x + bounds.w <= 0 || bounds.y + bounds.h <= 0) {
+					continue;
+				}
+				int x1 = std::max(0, bounds.x) / CELL_SIZE;
+				int y1 = std::max(0, bounds.y) / CELL_SIZE;
+				int x2 = std::min(gridWidth - 1,
+				                  (bounds.x + bounds.w - 1) / CELL_SIZE);
+				int y2 = std::min(gridHeight - 1,
+				                  (bounds.y + bounds.h - 1) / CELL_SIZE);
+				for (int j = y1; j <= y2; j++) {
+					for (int i = x1; i <= x2; i++) {
+						cells[j * gridWidth + i].push_back(widget);
+					}
+				}
+			}
+			gridDirty = false;
+		}
+
+		Entity* Panel::getWidgetAt(int x, int y)
+		{
+			if (x < 0 || y < 0 || x >= entityProperties.getWidth() ||
+			    y >= entityProperties.getHeight()) {
+				return nullptr;
+			}
+			if (gridDirty) {
+				buildGrid();
+			}
+
+			// Later widgets are on top
+			const std::vector<Entity*>& cell =
+			  cells[(y / CELL_SIZE) * gridWidth + x / CELL_SIZE];
+			for (auto it = cell.rbegin(); it != cell.rend(); it++) {
+				SDL_Rect bounds = getWidgetBounds(*it);
+				if (x >= bounds.x && x < bounds.x + bounds.w &&
+				    y >= bounds.y && y < bounds.y + bounds.h) {
+					return *it;
+				}
+			}
+			return nullptr;
+		}
+
+		void Panel::setBackgroundColor(const SDL_Color& color)
+		{
+			background = color;
+			invalidate();
+		}
+
+		void Panel::invalidate()
+		{
+			gridDirty = true;
+			dirtyRects.clear();
+			dirtyRects.push_back({ 0,
+			                       0,
+			                       entityProperties.getWidth(),
+			                       entityProperties.getHeight() });
+		}
+
+		void Panel::invalidate(const SDL_Rect& rect)
+		{
+			gridDirty = true;
+			markDirty(rect);
+		}
+
+		void Panel::markDirty(const SDL_Rect& rect)
+		{
+			SDL_Rect panelRect = { 0,
+				                   0,
+				                   entityProperties.getWidth(),
+				                   entityProperties.getHeight() };
+			SDL_Rect dirty;
+			if (!SDL_IntersectRect(&rect, &panelRect, &dirty)) {
+				return;
+			}
+
+			// Many small regions cost more than one redraw
+			if (dirtyRects.size() >= 8) {
+				dirtyRects.clear();
+				dirtyRects.push_back(panelRect);
+				return;
+			}
+			dirtyRects.push_back(dirty);
+		}
+
+		void Panel::handle(const SDL_Event& event)
+		{
+			SDL_Event local = event;
+			int x, y;
+			if (event.type == SDL_MOUSEMOTION) {
+				local.motion.x -= entityProperties.getXpos();
+				local.motion.y -= entityProperties.getYpos();
+				x = local.motion.x;
+				y = local.motion.y;
+			} else if (event.type == SDL_MOUSEBUTTONDOWN ||
+			           event.type == SDL_MOUSEBUTTONUP) {
+				local.button.x -= entityProperties.getXpos();
+				local.button.y -= entityProperties.getYpos();
+				x = local.button.x;
+				y = local.button.y;
+			} else {
+				return;
+			}
+
+			Entity* target = getWidgetAt(x, y);
+
+			// Let the widget the pointer left know
+			if (event.type == SDL_MOUSEMOTION && hovered != target) {
+				if (hovered != nullptr) {
+					hovered->handle(local);
+					markDirty(getWidgetBounds(hovered));
+				}
+				hovered = target;
+			}
+
+			if (target != nullptr) {
+				target->handle(local);
+				markDirty(getWidgetBounds(target));
+			}
+		}
+
+		void Panel::renderWidgets(const RenderData* data,
+		                          const SDL_Rect& clipRect,
+		                          bool replace) const
+		{
+			SDL_Renderer* renderer = data->getRenderer();
+
+			// In the cache the region is replaced, blending would keep the
+			// old content. On screen the background is blended on top.
+			if (replace || background.a != 0) {
+				SDL_BlendMode blendMode;
+				SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+				SDL_SetRenderDrawBlendMode(
+				  renderer, replace ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+				SDL_SetRenderDrawColor(renderer,
+				                       background.r,
+				                       background.g,
+				                       background.b,
+				                       background.a);
+				SDL_RenderFillRect(renderer, &clipRect);
+				SDL_SetRenderDrawBlendMode(renderer, blendMode);
+			}
+
+			for (auto widget : widgets) {
+				SDL_Rect bounds = getWidgetBounds(widget);
+				if (SDL_HasIntersection(&bounds, &clipRect)) {
+					widget->render(data);
+				}
+			}
+		}
+
+		bool Panel::redrawCache(const RenderData* data)
+		{
+			SDL_Renderer* renderer = data->getRenderer();
+			if (cache == nullptr) {
+				cache = SDL_CreateTexture(renderer,
+				                          SDL_PIXELFORMAT_RGBA8888,
+				                          SDL_TEXTUREACCESS_TARGET,
+				                          entityProperties.getWidth(),
+				                          entityProperties.getHeight());
+				if (cache == nullptr) {
+					return false;
+				}
+				SDL_SetTextureBlendMode(cache, SDL_BLENDMODE_BLEND);
+				invalidate();
+			}
+
+			if (dirtyRects.empty()) {
+				return true;
+			}
+
+			SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+			SDL_SetRenderTarget(renderer, cache);
+			for (auto& rect : dirtyRects) {
+				SDL_RenderSetClipRect(renderer, &rect);
+				renderWidgets(data, rect, true);
+			}
+			SDL_RenderSetClipRect(renderer, nullptr);
+			SDL_SetRenderTarget(renderer, previousTarget);
+
+			dirtyRects.clear();
+			return true;
+		}
+
+		void Panel::preRender(const GameData* data)
+		{
+			// Nested panels redraw their caches first
+			for (auto widget : widgets) {
+				widget->preRender(data);
+			}
+
+			// Without render target support the widgets are drawn directly
+			// in render
+			if (!redrawCache(data->getRenderData())) {
+				dirtyRects.clear();
+			}
+		}
+
+		void Panel::render(const RenderData* data) const
+		{
+			if (isDead() || !entityProperties.isVisible()) {
+				return;
+			}
+
+			SDL_Renderer* renderer = data->getRenderer();
+			SDL_Rect bounds = entityProperties.getBoundingBox();
+			if (cache != nullptr) {
+				SDL_RenderCopy(renderer, cache, nullptr, &bounds);
+				return;
+			}
+
+			SDL_Rect panelRect = { 0, 0, bounds.w, bounds.h };
+			SDL_RenderSetViewport(renderer, &bounds);
+			renderWidgets(data, panelRect, false);
+			SDL_RenderSetViewport(renderer, nullptr);
+		}
+	} // namespace ui
+} // namespace flat2d
@@ -0,0 +1,107 @@
+#ifndef PANEL_H_
+#define PANEL_H_
+
+#include <vector>
+
+#include "Entity.h"
+
+namespace flat2d {
+	namespace ui {
+		/**
+		 * A UI container holding widgets (Button objects, other Panel
+		 * objects or any Entity) positioned relative to the panel. Pointer
+		 * events are routed through a hit test grid to the widget under the
+		 * cursor only, so the widgets shouldn't be registered to the
+		 * EntityContainer themselves. The panel owns its widgets and deletes
+		 * them when it's destroyed.
+		 *
+		 * The widgets are rendered into a cached texture and only the
+		 * regions that changed (widgets that received events or were
+		 * invalidated) are redrawn. Call invalidate if a widget changes for
+		 * other reasons.
+		 */
+		class Panel : public flat2d::Entity
+		{
+		  private:
+			static const int CELL_SIZE = 32;
+
+			std::vector<Entity*> widgets;
+			std::vector<std::vector<Entity*>> cells;
+			std::vector<SDL_Rect> dirtyRects;
+			SDL_Texture* cache = nullptr;
+			SDL_Color background = { 0x0, 0x0, 0x0, 0x0 };
+			Entity* hovered = nullptr;
+			bool gridDirty = true;
+			int gridWidth = 0;
+			int gridHeight = 0;
+
+			void buildGrid();
+			SDL_Rect getWidgetBounds(const Entity* widget) const;
+			void markDirty(const SDL_Rect& rect);
+			void renderWidgets(const RenderData* data,
+			                   const SDL_Rect& clipRect,
+			                   bool replace) const;
+			bool redrawCache(const RenderData* data);
+
+		  public:
+			Panel(int x, int y, unsigned int w, unsigned int h);
+
+			~Panel();
+
+			/**
+			 * Add a widget to the Panel. The position of the widget is
+			 * relative to the Panel. Widgets added later are on top.
+			 * @param widget The widget, the Panel takes ownership
+			 */
+			void addWidget(Entity* widget);
+
+			/**
+			 * Remove a widget from the Panel. Ownership of the widget
+			 * returns to the caller.
+			 * @param widget The widget to remove
+			 */
+			void removeWidget(Entity* widget);
+
+			/**
+			 * Get the number of widgets in the Panel
+			 * @return The number of widgets
+			 */
+			size_t getWidgetCount() const;
+
+			/**
+			 * Find the top most widget at a position
+			 * @param x The x position relative to the Panel
+			 * @param y The y position relative to the Panel
+			 * @return The widget or nullptr
+			 */
+			Entity* getWidgetAt(int x, int y);
+
+			/**
+			 * Set the background color of the Panel
+			 * @param color The color, transparent by default
+			 */
+			void setBackgroundColor(const SDL_Color& color);
+
+			/**
+			 * Mark the whole Panel for redrawing and update the hit
+			 * testing after widgets were moved or resized
+			 */
+			void invalidate();
+
+			/**
+			 * Mark a region of the Panel for redrawing and update the hit
+			 * testing after widgets were moved or resized
+			 * @param rect The region relative to the Panel
+			 */
+			void invalidate(const SDL_Rect& rect);
+
+			virtual void render(const RenderData* data) const override;
+
+			virtual void preRender(const GameData* data) override;
+
+			virtual void handle(const SDL_Event& event) override;
+		};
+	} // namespace ui
+} // namespace flat2d
+
+#endif // PANEL_H_
@@ -0,0 +1,43 @@
+#include "RenderData.h"
+#include "Camera.h"
+
+namespace flat2d {
+	void RenderData::updateCameraTransforms()
+	{
+		if (camera == nullptr) {
+			return;
+		}
+
+		for (int depth = 0; depth < CAMERA_TRANSFORM_DEPTHS; depth++) {
+			cameraOffsets[depth] = camera->getOffsetFor(depth);
+		}
+		transformCameraPos = { camera->getXpos(), camera->getYpos() };
+		transformsValid = true;
+	}
+
+	SDL_Point RenderData::getCameraOffset(int depth) const
+	{
+		if (camera == nullptr) {
+			return { 0, 0 };
+		}
+
+		int index = depth > 0 ? depth : 0;
+		if (transformsValid && index < CAMERA_TRANSFORM_DEPTHS &&
+		    transformCameraPos.x == camera->getXpos() &&
+		    transformCameraPos.y == camera->getYpos()) {
+			return cameraOffsets[index];
+		}
+		return camera->getOffsetFor(depth);
+	}
+
+	void RenderData::transformToScreen(SDL_Rect* boxes,
+	                                   size_t count,
+	                                   int depth) const
+	{
+		SDL_Point offset = getCameraOffset(depth);
+		for (size_t i = 0; i < count; i++) {
+			boxes[i].x -= offset.x;
+			boxes[i].y -= offset.y;
+		}
+	}
+} // namespace flat2d
@@ -2,6 +2,7 @@
 #define RENDERDATA_H_
 
 #include <SDL.h>
+#include <cstddef>
 
 namespace flat2d {
 	class Camera;
@@ -18,9 +19,15 @@ namespace flat2d {
 	class RenderData
 	{
 	  private:
+		static const int CAMERA_TRANSFORM_DEPTHS = 16;
+
 		SDL_Renderer* renderer;
 		Camera* camera;
 
+		SDL_Point cameraOffsets[CAMERA_TRANSFORM_DEPTHS];
+		SDL_Point transformCameraPos = { 0, 0 };
+		bool transformsValid = false;
+
 	  public:
 		RenderData(SDL_Renderer* ren, Camera* cam)
 		  : renderer(ren)
@@ -38,6 +45,30 @@ namespace flat2d {
 		 * @return The Camera object pointer
 		 */
 		Camera* getCamera() const { return camera; }
+
+		/**
+		 * Compute the camera offsets of the common depths for the current
+		 * Camera position. Called by the GameEngine once per frame before
+		 * rendering.
+		 */
+		void updateCameraTransforms();
+
+		/**
+		 * Get the offset subtracted from world positions at a depth to get
+		 * screen positions. Uses the offsets computed by
+		 * updateCameraTransforms unless the Camera has moved since.
+		 * @param depth The depth
+		 * @return The x and y offset
+		 */
+		SDL_Point getCameraOffset(int depth = 0) const;
+
+		/**
+		 * Transform bounding boxes from world to screen coordinates
+		 * @param boxes The boxes to transform in place
+		 * @param count The number of boxes
+		 * @param depth The depth of the boxes
+		 */
+		void transformToScreen(SDL_Rect* boxes, size_t count, int depth) const;
 	};
 } // namespace flat2d
 
@@ -0,0 +1,54 @@
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include "Snapshot.h"
+
+namespace flat2d {
+	void Snapshot::write(const void* data, size_t size)
+	{
+		const Uint8* bytes = static_cast<const Uint8*>(data);
+		buffer.insert(buffer.end(), bytes, bytes + size);
+	}
+
+	void Snapshot::writeAt(size_t position, const void* data, size_t size)
+	{
+		assert(position + size <= buffer.size());
+		std::memcpy(&buffer[position], data, size);
+	}
+
+	bool Snapshot::read(void* data, size_t size)
+	{
+		if (readPosition + size > buffer.size()) {
+			return false;
+		}
+		if (size != 0) {
+			std::memcpy(data, &buffer[readPosition], size);
+		}
+		readPosition += size;
+		return true;
+	}
+
+	size_t Snapshot::getReadPosition() const { return readPosition; }
+
+	void Snapshot::setReadPosition(size_t position)
+	{
+		readPosition = position;
+	}
+
+	void Snapshot::clear()
+	{
+		buffer.clear();
+		readPosition = 0;
+	}
+
+	size_t Snapshot::size() const { return buffer.size(); }
+
+	const std::vector<Uint8>& Snapshot::getBuffer() const { return buffer; }
+
+	void Snapshot::setBuffer(const std::vector<Uint8>& data)
+	{
+		buffer = data;
+		readPosition = 0;
+	}
+} // namespace flat2d
@@ -0,0 +1,107 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include <SDL.h>
+#include <type_traits>
+#include <vector>
+
+namespace flat2d {
+	/**
+	 * A compact binary buffer holding saved game state. The EntityContainer
+	 * writes the state of every Entity into it and Entity objects can add
+	 * their own state by overriding Entity::writeState and Entity::readState.
+	 * Values are read back in the order they were written.
+	 */
+	class Snapshot
+	{
+	  private:
+		std::vector<Uint8> buffer;
+		size_t readPosition = 0;
+
+	  public:
+		/**
+		 * Append raw bytes to the Snapshot
+		 * @param data The data to write
+		 * @param size The number of bytes to write
+		 */
+		void write(const void* data, size_t size);
+
+		/**
+		 * Overwrite bytes previously written to the Snapshot
+		 * @param position The byte offset to write at
+		 * @param data The data to write
+		 * @param size The number of bytes to write
+		 */
+		void writeAt(size_t position, const void* data, size_t size);
+
+		/**
+		 * Read raw bytes from the Snapshot
+		 * @param data The destination
+		 * @param size The number of bytes to read
+		 * @return false if there weren't enough bytes left to read
+		 */
+		bool read(void* data, size_t size);
+
+		/**
+		 * Append a value to the Snapshot
+		 * @param value A trivially copyable value
+		 */
+		template<typename T>
+		void write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value,
+			              "Only trivially copyable values can be written");
+			write(&value, sizeof(T));
+		}
+
+		/**
+		 * Read a value from the Snapshot
+		 * @param value The destination
+		 * @return false if there weren't enough bytes left to read
+		 */
+		template<typename T>
+		bool read(T* value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value,
+			              "Only trivially copyable values can be read");
+			return read(value, sizeof(T));
+		}
+
+		/**
+		 * Get the read position
+		 * @return The byte offset of the next read
+		 */
+		size_t getReadPosition() const;
+
+		/**
+		 * Set the read position
+		 * @param position The byte offset of the next read
+		 */
+		void setReadPosition(size_t position);
+
+		/**
+		 * Empty the Snapshot, the memory is kept for reuse
+		 */
+		void clear();
+
+		/**
+		 * Get the size of the Snapshot
+		 * @return The size in bytes
+		 */
+		size_t size() const;
+
+		/**
+		 * Get the raw Snapshot data
+		 * @return The buffer
+		 */
+		const std::vector<Uint8>& getBuffer() const;
+
+		/**
+		 * Replace the Snapshot data and reset the read position
+		 * @param data The new data
+		 */
+		void setBuffer(const std::vector<Uint8>& data);
+	};
+} // namespace flat2d
+
+#endif // SNAPSHOT_H_
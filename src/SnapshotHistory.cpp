@@ -0,0 +1,175 @@
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "Snapshot.h"
+#include "SnapshotHistory.h"
+
+namespace flat2d {
+	void SnapshotHistory::encodeDelta(const std::vector<Uint8>& from,
+	                                  const std::vector<Uint8>& to,
+	                                  std::vector<Uint8>* delta)
+	{
+		auto xorAt = [&from, &to](size_t i) -> Uint8 {
+			return to[i] ^ (i < from.size() ? from[i] : 0);
+		};
+		auto append = [delta](const void* data, size_t size) {
+			const Uint8* bytes = static_cast<const Uint8*>(data);
+			delta->insert(delta->end(), bytes, bytes + size);
+		};
+
+		delta->clear();
+		Uint32 size = static_cast<Uint32>(to.size());
+		append(&size, sizeof(size));
+
+		// Runs of unchanged bytes followed by runs of changed bytes
+		size_t i = 0;
+		while (i < to.size()) {
+			Uint16 zeros = 0;
+			while (i < to.size() && zeros < 0xFFFF && xorAt(i) == 0) {
+				zeros++;
+				i++;
+			}
+
+			size_t start = i;
+			Uint16 literals = 0;
+			while (i < to.size() && literals < 0xFFFF && xorAt(i) != 0) {
+				literals++;
+				i++;
+			}
+
+			append(&zeros, sizeof(zeros));
+			append(&literals, sizeof(literals));
+			for (size_t j = start; j < i; j++) {
+				delta->push_back(xorAt(j));
+			}
+		}
+	}
+
+	bool SnapshotHistory::applyDelta(const std::vector<Uint8>& delta,
+	                                 std::vector<Uint8>* buffer)
+	{
+		Uint32 size;
+		if (delta.size() < sizeof(size)) {
+			return false;
+		}
+		std::memcpy(&size, &delta[0], sizeof(size));
+
+		// Bytes past the end of the previous frame are xor:ed against zero
+		buffer->resize(size, 0);
+
+		size_t position = sizeof(size);
+		size_t i = 0;
+		while (position < delta.size()) {
+			Uint16 zeros, literals;
+			if (delta.size() - position < sizeof(zeros) + sizeof(literals)) {
+				return false;
+			}
+			std::memcpy(&zeros, &delta[position], sizeof(zeros));
+			position += sizeof(zeros);
+			std::memcpy(&literals, &delta[position], sizeof(literals));
+			position += sizeof(literals);
+
+			// The run has to fit in both the delta and the buffer
+			i += zeros;
+			if (literals > delta.size() - position || i > size ||
+			    literals > size - i) {
+				return false;
+			}
+			for (Uint16 j = 0; j < literals; j++) {
+				(*buffer)[i++] ^= delta[position++];
+			}
+		}
+		return true;
+	}
+
+	void SnapshotHistory::push(const Snapshot& snapshot)
+	{
+		const std::vector<Uint8>& data = snapshot.getBuffer();
+		if (frameCount == 0 || capacity == 1) {
+			base = data;
+			latest = data;
+			frameCount = 1;
+			return;
+		}
+
+		// Fold the oldest delta into the base to make room
+		if (frameCount == capacity) {
+			if (!applyDelta(deltas.front(), &base)) {
+				// The history is broken, start over from this frame
+				clear();
+				push(snapshot);
+				return;
+			}
+			deltas.pop_front();
+			frameCount--;
+		}
+
+		deltas.emplace_back();
+		encodeDelta(latest, data, &deltas.back());
+		latest = data;
+		frameCount++;
+	}
+
+	bool SnapshotHistory::get(size_t framesBack, Snapshot* snapshot) const
+	{
+		if (framesBack >= frameCount) {
+			return false;
+		}
+		if (framesBack == 0) {
+			snapshot->setBuffer(latest);
+			return true;
+		}
+
+		std::vector<Uint8> buffer = base;
+		size_t index = frameCount - 1 - framesBack;
+		for (size_t i = 0; i < index; i++) {
+			if (!applyDelta(deltas[i], &buffer)) {
+				return false;
+			}
+		}
+		snapshot->setBuffer(buffer);
+		return true;
+	}
+
+	void SnapshotHistory::rewind(size_t framesBack)
+	{
+		if (framesBack == 0) {
+			return;
+		}
+		if (framesBack >= frameCount) {
+			clear();
+			return;
+		}
+
+		size_t index = frameCount - 1 - framesBack;
+		latest = base;
+		for (size_t i = 0; i < index; i++) {
+			if (!applyDelta(deltas[i], &latest)) {
+				clear();
+				return;
+			}
+		}
+		deltas.resize(index);
+		frameCount = index + 1;
+	}
+
+	void SnapshotHistory::clear()
+	{
+		base.clear();
+		latest.clear();
+		deltas.clear();
+		frameCount = 0;
+	}
+
+	size_t SnapshotHistory::size() const { return frameCount; }
+
+	size_t SnapshotHistory::getMemoryUsage() const
+	{
+		size_t usage = base.size() + latest.size();
+		for (auto& delta : deltas) {
+			usage += delta.size();
+		}
+		return usage;
+	}
+} // namespace flat2d
@@ -0,0 +1,99 @@
+#ifndef SNAPSHOTHISTORY_H_
+#define SNAPSHOTHISTORY_H_
+
+#include <SDL.h>
+#include <deque>
+#include <vector>
+
+namespace flat2d {
+	class Snapshot;
+
+	/**
+	 * Keeps the Snapshot objects of the last few frames for rollback. The
+	 * oldest frame is kept in full and every following frame as a delta
+	 * against the one before it (xor with runs of unchanged bytes
+	 * compressed). Consecutive frames usually differ very little so the
+	 * memory use stays close to two full snapshots.
+	 */
+	class SnapshotHistory
+	{
+	  private:
+		size_t capacity;
+		std::vector<Uint8> base;
+		std::vector<Uint8> latest;
+		std::deque<std::vector<Uint8>> deltas;
+		size_t frameCount = 0;
+
+	  public:
+		/**
+		 * Encode the difference between two buffers
+		 * @param from The previous buffer
+		 * @param to The new buffer
+		 * @param delta The vector to write the delta into
+		 */
+		static void encodeDelta(const std::vector<Uint8>& from,
+		                        const std::vector<Uint8>& to,
+		                        std::vector<Uint8>* delta);
+
+		/**
+		 * Turn a buffer into the next one by applying a delta from
+		 * encodeDelta. Truncated or corrupt deltas are rejected, the
+		 * buffer content is undefined afterwards.
+		 * @param delta The delta
+		 * @param buffer The buffer to update
+		 * @return false if the delta is malformed
+		 */
+		static bool applyDelta(const std::vector<Uint8>& delta,
+		                       std::vector<Uint8>* buffer);
+
+		/**
+		 * Create a SnapshotHistory
+		 * @param frames The number of frames to keep
+		 */
+		explicit SnapshotHistory(size_t frames)
+		  : capacity(frames > 0 ? frames : 1)
+		{}
+
+		/**
+		 * Add the Snapshot of a new frame. The oldest frame is dropped when
+		 * the history is full.
+		 * @param snapshot The Snapshot to add
+		 */
+		void push(const Snapshot& snapshot);
+
+		/**
+		 * Get the Snapshot of an earlier frame
+		 * @param framesBack The number of frames back, 0 is the latest
+		 * @param snapshot The Snapshot to write into
+		 * @return false if the history doesn't reach that far back or a
+		 * delta is corrupt
+		 */
+		bool get(size_t framesBack, Snapshot* snapshot) const;
+
+		/**
+		 * Drop every frame newer than a given frame. Use after restoring an
+		 * earlier frame so the re-simulated frames can be pushed.
+		 * @param framesBack The number of frames back to keep as latest
+		 */
+		void rewind(size_t framesBack);
+
+		/**
+		 * Drop all frames
+		 */
+		void clear();
+
+		/**
+		 * Get the number of frames kept
+		 * @return The number of frames
+		 */
+		size_t size() const;
+
+		/**
+		 * Get the number of bytes used to store the frames
+		 * @return The memory use in bytes
+		 */
+		size_t getMemoryUsage() const;
+	};
+} // namespace flat2d
+
+#endif // SNAPSHOTHISTORY_H_
@@ -2,16 +2,59 @@
 #define SPINLOCK_H_
 
 #include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||            \
+  defined(_M_IX86)
+#include <immintrin.h>
+#define FLAT_CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define FLAT_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define FLAT_CPU_RELAX()
+#endif
 
 namespace flat2d {
+	/**
+	 * Contention counters of a lock. Read them through the lock's getStats.
+	 */
+	struct LockStats
+	{
+		// Keeps the counters off the cache line of the lock word. Padding
+		// rather than alignas since locks are members of heap allocated
+		// objects and C++14 new ignores extended alignment.
+		char padding[64];
+		std::atomic<size_t> acquisitions{ 0 };
+		std::atomic<size_t> contentions{ 0 };
+		std::atomic<size_t> spins{ 0 };
+		std::atomic<size_t> blocks{ 0 };
+
+		void reset()
+		{
+			acquisitions.store(0, std::memory_order_relaxed);
+			contentions.store(0, std::memory_order_relaxed);
+			spins.store(0, std::memory_order_relaxed);
+			blocks.store(0, std::memory_order_relaxed);
+		}
+	};
+
 	/**
 	 * A spinlock implementation: https://en.wikipedia.org/wiki/Spinlock
+	 * Waiting threads spin on a read (test and test and set) with a pause
+	 * and exponential backoff and start yielding their time slice once the
+	 * backoff is exhausted. Use it for very short critical sections.
 	 * @author Linus Probert <linus.probert@gmail.com>
 	 */
 	class SpinLock
 	{
 	  private:
-		std::atomic_flag lck = ATOMIC_FLAG_INIT;
+		static const unsigned int MAX_BACKOFF = 64;
+
+		std::atomic<bool> locked{ false };
+		LockStats stats;
 
 	  public:
 		/**
@@ -19,14 +62,212 @@ namespace flat2d {
 		 */
 		void lock()
 		{
-			while (lck.test_and_set(std::memory_order_acquire)) {
+			if (!locked.exchange(true, std::memory_order_acquire)) {
+				stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+				return;
 			}
+
+			stats.contentions.fetch_add(1, std::memory_order_relaxed);
+			unsigned int backoff = 1;
+			size_t spins = 0;
+			do {
+				// Spin on a read to keep the cache line shared
+				while (locked.load(std::memory_order_relaxed)) {
+					spins++;
+					if (backoff < MAX_BACKOFF) {
+						for (unsigned int i = 0; i < backoff; i++) {
+							FLAT_CPU_RELAX();
+						}
+						backoff <<= 1;
+					} else {
+						std::this_thread::yield();
+					}
+				}
+			} while (locked.exchange(true, std::memory_order_acquire));
+			stats.spins.fetch_add(spins, std::memory_order_relaxed);
+			stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Try to lock the spinlock without waiting
+		 * @return true if the lock was acquired
+		 */
+		bool try_lock()
+		{
+			if (locked.load(std::memory_order_relaxed) ||
+			    locked.exchange(true, std::memory_order_acquire)) {
+				return false;
+			}
+			stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+			return true;
 		}
 
 		/**
 		 * Unlock the spinlock
 		 */
-		void unlock() { lck.clear(std::memory_order_release); }
+		void unlock() { locked.store(false, std::memory_order_release); }
+
+		/**
+		 * Get the contention counters
+		 * @return The LockStats
+		 */
+		const LockStats& getStats() const { return stats; }
+	};
+
+	/**
+	 * A fair spinlock granting the lock in the order it was requested.
+	 * Waiting threads back off proportionally to their place in the
+	 * queue. Use it where a SpinLock would starve some threads.
+	 */
+	class TicketLock
+	{
+	  private:
+		static const size_t YIELD_DISTANCE = 8;
+
+		// Padded apart so arriving threads don't invalidate the line the
+		// waiting threads spin on, see LockStats
+		struct PaddedCounter
+		{
+			std::atomic<size_t> value{ 0 };
+			char padding[64];
+		};
+
+		PaddedCounter nextTicket;
+		PaddedCounter nowServing;
+		LockStats stats;
+
+	  public:
+		/**
+		 * Lock the ticket lock
+		 */
+		void lock()
+		{
+			size_t ticket =
+			  nextTicket.value.fetch_add(1, std::memory_order_relaxed);
+			size_t serving = nowServing.value.load(std::memory_order_acquire);
+			if (serving != ticket) {
+				stats.contentions.fetch_add(1, std::memory_order_relaxed);
+			}
+			size_t spins = 0;
+			while (serving != ticket) {
+				spins++;
+				size_t distance = ticket - serving;
+				if (distance > YIELD_DISTANCE) {
+					std::this_thread::yield();
+				} else {
+					for (size_t i = 0; i < distance * 4; i++) {
+						FLAT_CPU_RELAX();
+					}
+				}
+				serving = nowServing.value.load(std::memory_order_acquire);
+			}
+			stats.spins.fetch_add(spins, std::memory_order_relaxed);
+			stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Unlock the ticket lock
+		 */
+		void unlock()
+		{
+			// Only the holder writes nowServing
+			size_t serving = nowServing.value.load(std::memory_order_relaxed);
+			nowServing.value.store(serving + 1, std::memory_order_release);
+		}
+
+		/**
+		 * Get the contention counters
+		 * @return The LockStats
+		 */
+		const LockStats& getStats() const { return stats; }
+	};
+
+	/**
+	 * A mutex that spins for a short while before putting the thread to
+	 * sleep. Uncontended locking costs a single atomic operation and
+	 * waiters that would spin for long don't burn a core. Use it for
+	 * critical sections of unknown length.
+	 */
+	class HybridMutex
+	{
+	  private:
+		static const unsigned int SPIN_LIMIT = 100;
+
+		// 0 unlocked, 1 locked, 2 locked with sleeping waiters
+		std::atomic<int> state{ 0 };
+		std::mutex sleepMutex;
+		std::condition_variable sleepCondition;
+		LockStats stats;
+
+		bool tryAcquire()
+		{
+			int expected = 0;
+			return state.compare_exchange_strong(
+			  expected, 1, std::memory_order_acquire);
+		}
+
+	  public:
+		/**
+		 * Lock the mutex
+		 */
+		void lock()
+		{
+			if (tryAcquire()) {
+				stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			stats.contentions.fetch_add(1, std::memory_order_relaxed);
+			unsigned int spins = 0;
+			for (; spins < SPIN_LIMIT; spins++) {
+				FLAT_CPU_RELAX();
+				if (state.load(std::memory_order_relaxed) == 0 &&
+				    tryAcquire()) {
+					stats.spins.fetch_add(spins + 1, std::memory_order_relaxed);
+					stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+
+			// Mark the lock as having waiters and sleep until it's free
+			stats.spins.fetch_add(spins, std::memory_order_relaxed);
+			stats.blocks.fetch_add(1, std::memory_order_relaxed);
+			std::unique_lock<std::mutex> guard(sleepMutex);
+			while (state.exchange(2, std::memory_order_acquire) != 0) {
+				sleepCondition.wait(guard);
+			}
+			stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Try to lock the mutex without waiting
+		 * @return true if the lock was acquired
+		 */
+		bool try_lock()
+		{
+			if (!tryAcquire()) {
+				return false;
+			}
+			stats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		/**
+		 * Unlock the mutex
+		 */
+		void unlock()
+		{
+			if (state.exchange(0, std::memory_order_release) == 2) {
+				std::lock_guard<std::mutex> guard(sleepMutex);
+				sleepCondition.notify_one();
+			}
+		}
+
+		/**
+		 * Get the contention counters
+		 * @return The LockStats
+		 */
+		const LockStats& getStats() const { return stats; }
 	};
 } // namespace flat2d
 
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <vector>
+
+#include "Entity.h"
+#include "EntityProperties.h"
+#include "StaticSpatialIndex.h"
+
+namespace flat2d {
+	void StaticSpatialIndex::insert(Entity* entity)
+	{
+		if (bodyIndexes.find(entity) != bodyIndexes.end()) {
+			return;
+		}
+		bodyIndexes[entity] = bodies.size();
+		bodies.push_back(entity);
+		builtShapes.push_back(EntityShape());
+		dirty = true;
+	}
+
+	void StaticSpatialIndex::remove(Entity* entity)
+	{
+		auto it = bodyIndexes.find(entity);
+		if (it == bodyIndexes.end()) {
+			return;
+		}
+		size_t index = it->second;
+		bodyIndexes.erase(it);
+		if (!dirty) {
+			clearCellsFor(entity, builtShapes[index]);
+		}
+
+		// Swap and pop, the order of the bodies doesn't matter
+		if (index != bodies.size() - 1) {
+			bodies[index] = bodies.back();
+			builtShapes[index] = builtShapes.back();
+			bodyIndexes[bodies[index]] = index;
+		}
+		bodies.pop_back();
+		builtShapes.pop_back();
+	}
+
+	void StaticSpatialIndex::invalidate() { dirty = true; }
+
+	void StaticSpatialIndex::clear()
+	{
+		bodies.clear();
+		builtShapes.clear();
+		bodyIndexes.clear();
+		cells.clear();
+		removedCells = 0;
+		dirty = false;
+	}
+
+	void StaticSpatialIndex::setDimension(unsigned int dim)
+	{
+		dimension = dim;
+		dirty = true;
+	}
+
+	template<typename Func>
+	void StaticSpatialIndex::forEachPartitionOf(const EntityShape& shape,
+	                                            Func func) const
+	{
+		int xmax = shape.x + shape.w;
+		int ymax = shape.y + shape.h;
+		int step = static_cast<int>(dimension);
+
+		// Visit every partition the collider covers, edges included
+		for (int i = shape.x;; i = std::min(i + step, xmax)) {
+			for (int j = shape.y;; j = std::min(j + step, ymax)) {
+				func(MapArea::partitionFor(i, j, dimension));
+				if (j >= ymax) {
+					break;
+				}
+			}
+			if (i >= xmax) {
+				break;
+			}
+		}
+	}
+
+	void StaticSpatialIndex::clearCellsFor(const Entity* entity,
+	                                       const EntityShape& shape)
+	{
+		// The shape from the last build finds exactly the entries made
+		forEachPartitionOf(shape, [this, entity](const MapArea& area) {
+			auto range = std::equal_range(cells.begin(),
+			                              cells.end(),
+			                              Cell(area, nullptr),
+			                              &StaticSpatialIndex::compareCells);
+			auto it = std::find_if(
+			  range.first, range.second, [entity](const Cell& cell) {
+				  return cell.second == entity;
+			  });
+			// Partitions can be visited twice, only the first one clears
+			if (it != range.second) {
+				it->second = nullptr;
+				removedCells++;
+			}
+		});
+
+		// Compact once most entries are empty
+		if (removedCells * 2 > cells.size()) {
+			dirty = true;
+		}
+	}
+
+	bool StaticSpatialIndex::orderCells(const Cell& c1, const Cell& c2)
+	{
+		if (compareCells(c1, c2)) {
+			return true;
+		} else if (compareCells(c2, c1)) {
+			return false;
+		}
+		return c1.second < c2.second;
+	}
+
+	void StaticSpatialIndex::build()
+	{
+		if (!dirty) {
+			return;
+		}
+
+		cells.clear();
+		removedCells = 0;
+		for (size_t i = 0; i < bodies.size(); i++) {
+			Entity* body = bodies[i];
+			builtShapes[i] = body->getEntityProperties().getColliderShape();
+			forEachPartitionOf(builtShapes[i],
+			                   [this, body](const MapArea& area) {
+				                   cells.push_back(Cell(area, body));
+			                   });
+		}
+
+		// Sort on partition and drop duplicate entries
+		std::sort(cells.begin(), cells.end(), &StaticSpatialIndex::orderCells);
+		cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+		dirty = false;
+	}
+
+	size_t StaticSpatialIndex::size() const { return bodies.size(); }
+
+	size_t StaticSpatialIndex::getEntryCount()
+	{
+		build();
+		return cells.size() - removedCells;
+	}
+} // namespace flat2d
@@ -0,0 +1,121 @@
+#ifndef STATICSPATIALINDEX_H_
+#define STATICSPATIALINDEX_H_
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "EntityShape.h"
+#include "MapArea.h"
+
+namespace flat2d {
+	class Entity;
+
+	/**
+	 * A build once spatial index for static (immovable) collidable Entity
+	 * objects. The bodies are bucketed into the same grid as the dynamic
+	 * spatial partitions but stored in a packed array sorted on partition.
+	 * The index is only rebuilt when bodies are added or moved. Removed
+	 * bodies leave empty entries behind that are skipped by queries and
+	 * dropped on the next rebuild.
+	 * The EntityContainer also keeps triggers in one since they seldom move.
+	 * It's used by the EntityContainer and should be left alone in game code.
+	 */
+	class StaticSpatialIndex
+	{
+	  private:
+		typedef std::pair<MapArea, Entity*> Cell;
+
+		unsigned int dimension = 100;
+		bool dirty = false;
+		std::vector<Entity*> bodies;
+		std::vector<EntityShape> builtShapes;
+		std::unordered_map<const Entity*, size_t> bodyIndexes;
+		std::vector<Cell> cells;
+		size_t removedCells = 0;
+
+		template<typename Func>
+		void forEachPartitionOf(const EntityShape& shape, Func func) const;
+		void clearCellsFor(const Entity* entity, const EntityShape& shape);
+		static bool orderCells(const Cell& c1, const Cell& c2);
+
+		static bool compareCells(const Cell& c1, const Cell& c2)
+		{
+			return c1.first < c2.first;
+		}
+
+	  public:
+		/**
+		 * Add a static Entity to the index. The index will be rebuilt before
+		 * the next query.
+		 * @param entity The Entity to add
+		 */
+		void insert(Entity* entity);
+
+		/**
+		 * Remove a static Entity from the index. Its entries are cleared in
+		 * place, the index isn't rebuilt.
+		 * @param entity The Entity to remove
+		 */
+		void remove(Entity* entity);
+
+		/**
+		 * Mark the index for rebuilding before the next query. Call when a
+		 * body in the index has moved.
+		 */
+		void invalidate();
+
+		/**
+		 * Remove all Entity objects from the index
+		 */
+		void clear();
+
+		/**
+		 * Set the partition dimension. Should match the dimension used for
+		 * the dynamic spatial partitions.
+		 * @param dim The partition dimension
+		 */
+		void setDimension(unsigned int dim);
+
+		/**
+		 * Sort the bodies into the partitions if anything has changed since
+		 * the last build. This is done automatically before queries.
+		 */
+		void build();
+
+		/**
+		 * Get the number of static bodies in the index
+		 * @return The number of bodies
+		 */
+		size_t size() const;
+
+		/**
+		 * Get the number of occupied partition entries (body/partition pairs)
+		 * @return The number of entries
+		 */
+		size_t getEntryCount();
+
+		/**
+		 * Call the provided function for every static body in a partition
+		 * @param area The partition to look in
+		 * @param func The callback, called with an Entity*
+		 */
+		template<typename Func>
+		void forEachIn(const MapArea& area, Func func)
+		{
+			build();
+			auto range = std::equal_range(cells.begin(),
+			                              cells.end(),
+			                              Cell(area, nullptr),
+			                              &StaticSpatialIndex::compareCells);
+			for (auto it = range.first; it != range.second; ++it) {
+				if (it->second != nullptr) {
+					func(it->second);
+				}
+			}
+		}
+	};
+} // namespace flat2d
+
+#endif // STATICSPATIALINDEX_H_
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <mutex>
+
+#include "TaskScheduler.h"
+
+namespace flat2d {
+	TaskId TaskScheduler::submit(const Task& task, int priority)
+	{
+		std::lock_guard<SpinLock> guard(queueLock);
+		TaskId id = nextId++;
+		queues[priority].push_back({ id, task });
+		pendingCount++;
+		return id;
+	}
+
+	bool TaskScheduler::cancel(TaskId id)
+	{
+		std::lock_guard<SpinLock> guard(queueLock);
+		for (auto& queue : queues) {
+			auto it = std::find_if(
+			  queue.second.begin(),
+			  queue.second.end(),
+			  [id](const Entry& entry) { return entry.id == id; });
+			if (it != queue.second.end()) {
+				queue.second.erase(it);
+				pendingCount--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool TaskScheduler::popTask(Entry* entry, int* priority)
+	{
+		std::lock_guard<SpinLock> guard(queueLock);
+		for (auto& queue : queues) {
+			if (!queue.second.empty()) {
+				*entry = std::move(queue.second.front());
+				*priority = queue.first;
+				queue.second.pop_front();
+				pendingCount--;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	size_t TaskScheduler::run(float milliseconds)
+	{
+		milliseconds = std::max(milliseconds, minimumSlice);
+		if (milliseconds <= 0.0f) {
+			return 0;
+		}
+
+		Uint64 start = SDL_GetPerformanceCounter();
+		Uint64 budget = static_cast<Uint64>(
+		  milliseconds * SDL_GetPerformanceFrequency() / 1000.0f);
+
+		size_t runs = 0;
+		Entry entry;
+		int priority;
+		while (SDL_GetPerformanceCounter() - start < budget &&
+		       popTask(&entry, &priority)) {
+			runs++;
+			if (entry.task()) {
+				completedCount++;
+				continue;
+			}
+
+			// Unfinished tasks get their next slice after the others
+			std::lock_guard<SpinLock> guard(queueLock);
+			queues[priority].push_back(std::move(entry));
+			pendingCount++;
+		}
+		return runs;
+	}
+
+	void TaskScheduler::setMinimumSlice(float milliseconds)
+	{
+		minimumSlice = std::max(milliseconds, 0.0f);
+	}
+
+	float TaskScheduler::getMinimumSlice() const { return minimumSlice; }
+
+	size_t TaskScheduler::getPendingCount()
+	{
+		std::lock_guard<SpinLock> guard(queueLock);
+		return pendingCount;
+	}
+
+	size_t TaskScheduler::getCompletedCount() const { return completedCount; }
+
+	void TaskScheduler::clear()
+	{
+		std::lock_guard<SpinLock> guard(queueLock);
+		queues.clear();
+		pendingCount = 0;
+	}
+} // namespace flat2d
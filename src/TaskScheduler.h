@@ -0,0 +1,123 @@
+#ifndef TASKSCHEDULER_H_
+#define TASKSCHEDULER_H_
+
+#include <SDL.h>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+
+#include "SpinLock.h"
+
+namespace flat2d {
+	typedef Uint64 TaskId;
+
+	/**
+	 * Task priorities, higher priorities run first
+	 */
+	enum TaskPriority
+	{
+		TASK_LOW = 0,
+		TASK_NORMAL = 1,
+		TASK_HIGH = 2
+	};
+
+	/**
+	 * Runs deferrable work on the main thread in the time left of a frame.
+	 * The GameEngine gives the scheduler the slack between rendering a
+	 * frame and the frame deadline instead of sleeping it away.
+	 *
+	 * Tasks run in priority order, and in submission order within a
+	 * priority. A task returns true when it's done. Returning false puts
+	 * it back at the end of its priority so long running work, like path
+	 * finding, can be sliced into short steps. Tasks can be submitted from
+	 * any thread, for example by a JobPool job handing a decoded image
+	 * back for the texture upload, but only run on the thread calling
+	 * run.
+	 */
+	class TaskScheduler
+	{
+	  public:
+		typedef std::function<bool()> Task;
+
+	  private:
+		struct Entry
+		{
+			TaskId id;
+			Task task;
+		};
+
+		std::map<int, std::deque<Entry>, std::greater<int>> queues;
+		SpinLock queueLock;
+		TaskId nextId = 1;
+		size_t pendingCount = 0;
+		float minimumSlice = 0.0f;
+		size_t completedCount = 0;
+
+		TaskScheduler(const TaskScheduler&);  // Don't implement
+		void operator=(const TaskScheduler&); // Don't implement
+
+		bool popTask(Entry* entry, int* priority);
+
+	  public:
+		TaskScheduler() {}
+
+		/**
+		 * Queue a task
+		 * @param task The task, returning true when it's done
+		 * @param priority The priority, see TaskPriority
+		 * @return The TaskId
+		 */
+		TaskId submit(const Task& task, int priority = TASK_NORMAL);
+
+		/**
+		 * Remove a queued task. A task can't cancel itself while running,
+		 * return true instead.
+		 * @param id The TaskId
+		 * @return true if the task was queued
+		 */
+		bool cancel(TaskId id);
+
+		/**
+		 * Run tasks until the time is up or the queue is empty. A task
+		 * isn't interrupted so keep them short. The minimum slice is used
+		 * if it's longer than the given time.
+		 * @param milliseconds The time to spend
+		 * @return The number of task runs
+		 */
+		size_t run(float milliseconds);
+
+		/**
+		 * Set the time the scheduler gets every frame even without any
+		 * slack left, so low priority work isn't starved by slow frames.
+		 * Defaults to 0.
+		 * @param milliseconds The minimum slice
+		 */
+		void setMinimumSlice(float milliseconds);
+
+		/**
+		 * Get the minimum slice
+		 * @return The minimum slice in milliseconds
+		 */
+		float getMinimumSlice() const;
+
+		/**
+		 * Get the number of queued tasks
+		 * @return The task count
+		 */
+		size_t getPendingCount();
+
+		/**
+		 * Get the number of tasks that have completed
+		 * @return The completed count
+		 */
+		size_t getCompletedCount() const;
+
+		/**
+		 * Remove all queued tasks
+		 */
+		void clear();
+	};
+} // namespace flat2d
+
+#endif // TASKSCHEDULER_H_
@@ -1,14 +1,64 @@
 #include "UID.h"
 
 namespace flat2d {
-	size_t UID::uid = 1;
+	std::atomic<size_t> UID::uid(1);
+	std::atomic<bool> UID::recycling(false);
+	std::atomic<size_t> UID::freeCount(0);
 	SpinLock UID::lock;
+	std::set<size_t> UID::freeIds;
+
+	// The block of ids reserved by the current thread
+	static thread_local size_t blockNext = 0;
+	static thread_local size_t blockEnd = 0;
 
 	size_t UID::generate()
 	{
+		// Only take the lock when there is a free id to take
+		if (recycling.load(std::memory_order_relaxed) &&
+		    freeCount.load(std::memory_order_relaxed) != 0) {
+			lock.lock();
+			if (!freeIds.empty()) {
+				size_t id = *freeIds.begin();
+				freeIds.erase(freeIds.begin());
+				freeCount.store(freeIds.size(), std::memory_order_relaxed);
+				lock.unlock();
+				return id;
+			}
+			lock.unlock();
+		}
+
+		if (blockNext == blockEnd) {
+			blockNext = uid.fetch_add(BLOCK_SIZE, std::memory_order_relaxed);
+			blockEnd = blockNext + BLOCK_SIZE;
+		}
+		return blockNext++;
+	}
+
+	void UID::release(size_t id)
+	{
+		if (!recycling.load(std::memory_order_relaxed)) {
+			return;
+		}
 		lock.lock();
-		size_t id = uid++;
+		// A set so an id released twice is still only handed out once
+		freeIds.insert(id);
+		freeCount.store(freeIds.size(), std::memory_order_relaxed);
 		lock.unlock();
-		return id;
+	}
+
+	void UID::setRecycling(bool recycle)
+	{
+		recycling.store(recycle, std::memory_order_relaxed);
+		if (!recycle) {
+			lock.lock();
+			freeIds.clear();
+			freeCount.store(0, std::memory_order_relaxed);
+			lock.unlock();
+		}
+	}
+
+	bool UID::isRecycling()
+	{
+		return recycling.load(std::memory_order_relaxed);
 	}
 } // namespace flat2d
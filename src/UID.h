@@ -2,26 +2,62 @@
 #define UID_H_
 
 #include "SpinLock.h"
+#include <atomic>
 #include <cstddef>
+#include <set>
 
 namespace flat2d {
 	/**
 	 * A Unique id object heavily used by the Entity class
+	 *
+	 * Ids are handed out from blocks reserved per thread so threads
+	 * creating entities concurrently rarely touch the shared counter.
+	 * Optionally released ids can be recycled to keep the id space dense.
 	 * @author Linus Probert <linus.probert@gmail.com>
 	 */
 	class UID
 	{
 	  private:
-		static size_t uid;
+		static const size_t BLOCK_SIZE = 32;
+
+		static std::atomic<size_t> uid;
+		static std::atomic<bool> recycling;
+		static std::atomic<size_t> freeCount;
 		static SpinLock lock;
+		static std::set<size_t> freeIds;
 
 	  public:
 		/**
-		 * Generate a new unique id. These are all sequential and
-		 * their life only spans runtime
+		 * Generate a new unique id. These are sequential within a thread
+		 * and their life only spans runtime
 		 * @return a new uid
 		 */
 		static size_t generate();
+
+		/**
+		 * Return an id for reuse. Has no effect unless recycling is
+		 * enabled. Releasing an id that is already free has no effect.
+		 * The EntityContainer releases the ids of the Entity objects it
+		 * deletes.
+		 * @param id The id that is no longer in use
+		 */
+		static void release(size_t id);
+
+		/**
+		 * Enable reuse of released ids, the lowest free id is reused first.
+		 * Keeps the id space dense for arrays indexed by id. Ids then no
+		 * longer follow creation order and stored ids may refer to a
+		 * newer Entity, so the EntityContainer refuses to restore
+		 * snapshots while recycling is enabled.
+		 * @param recycle true or false, defaults to false
+		 */
+		static void setRecycling(bool recycle);
+
+		/**
+		 * Check if released ids are reused
+		 * @return true or false
+		 */
+		static bool isRecycling();
 	};
 } // namespace flat2d
 
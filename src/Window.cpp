@@ -17,8 +17,11 @@ namespace flat2d {
 			return false;
 		}
 
-		renderer = SDL_CreateRenderer(
-		  window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+		renderer = SDL_CreateRenderer(window,
+		                              -1,
+		                              SDL_RENDERER_ACCELERATED |
+		                                SDL_RENDERER_PRESENTVSYNC |
+		                                SDL_RENDERER_TARGETTEXTURE);
 		if (renderer == nullptr) {
 			std::cerr << "Renderer could not be created: " << SDL_GetError()
 			          << std::endl;
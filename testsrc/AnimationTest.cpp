@@ -1,4 +1,5 @@
 #include "../src/Animation.h"
+#include "EntityImpl.h"
 #include "catch.hpp"
 
 TEST_CASE("AnimationTest", "[animation]")
@@ -64,4 +65,49 @@ TEST_CASE("AnimationTest", "[animation]")
 		REQUIRE(clip->w == 5);
 		REQUIRE(clip->h == 5);
 	}
+
+	SECTION("ClockTest", "[animation]")
+	{
+		auto definition =
+		  std::make_shared<flat2d::AnimationDefinition>(clips, 100);
+		flat2d::Animation first(definition);
+		flat2d::Animation second(definition);
+		REQUIRE(first.getDefinition() == second.getDefinition());
+
+		flat2d::AnimationClock::reset();
+		first.start();
+		REQUIRE(first.run()->x == 0);
+		flat2d::AnimationClock::advance(0.05f);
+		second.start();
+		flat2d::AnimationClock::advance(0.05f);
+		REQUIRE(first.run()->x == 5);
+		REQUIRE(second.run()->x == 0);
+		flat2d::AnimationClock::advance(0.1f);
+		REQUIRE(first.run()->x == 0);
+		REQUIRE(second.run()->x == 5);
+	}
+
+	SECTION("InternTest", "[animation]")
+	{
+		flat2d::AnimationId walk = flat2d::Animation::intern("walk");
+		REQUIRE(walk != flat2d::Animation::intern("run"));
+		REQUIRE(walk == flat2d::Animation::intern("walk"));
+	}
+
+	SECTION("EntityAnimationTest", "[animation]")
+	{
+		EntityImpl entity(0, 0);
+		flat2d::AnimationId walk = flat2d::Animation::intern("walk");
+		flat2d::Animation* walking = new flat2d::Animation(clips, 0);
+		entity.addAnimation(walk, walking);
+
+		REQUIRE(entity.getAnimation(walk) == walking);
+		REQUIRE(entity.getAnimation(flat2d::Animation::intern("run")) ==
+		        nullptr);
+		REQUIRE(entity.getCurrentAnimation() == nullptr);
+		entity.startAnimation("walk");
+		REQUIRE(entity.getCurrentAnimation() == walking);
+		entity.stopAnimations();
+		REQUIRE(entity.getCurrentAnimation() == nullptr);
+	}
 }
@@ -1,6 +1,7 @@
 #include <SDL.h>
 
 #include "../src/Camera.h"
+#include "../src/RenderData.h"
 #include "catch.hpp"
 
 TEST_CASE("CameraTests", "[camera]")
@@ -95,5 +96,35 @@ TEST_CASE("CameraTests", "[camera]")
 		REQUIRE(camera->isOutOfMapBounds(box));
 	}
 
+	SECTION("Test cached transforms", "[camera]")
+	{
+		flat2d::RenderData renderData(nullptr, camera);
+		camera->setMapDimensions(1000, 1000);
+		camera->centerOn(400, 300);
+
+		// Uncached offsets match the per position functions
+		SDL_Point offset = renderData.getCameraOffset(2);
+		REQUIRE(100 - offset.x == camera->getScreenXposFor(100, 2));
+		REQUIRE(100 - offset.y == camera->getScreenYposFor(100, 2));
+
+		renderData.updateCameraTransforms();
+		SDL_Rect boxes[2] = { { 400, 300, 10, 10 }, { 0, 0, 10, 10 } };
+		renderData.transformToScreen(boxes, 2, 0);
+		REQUIRE(boxes[0].x == 100);
+		REQUIRE(boxes[0].y == 50);
+		REQUIRE(boxes[1].x == -300);
+		REQUIRE(!camera->isVisibleOnScreen(boxes[1]));
+
+		offset = renderData.getCameraOffset(3);
+		REQUIRE(offset.x == camera->getOffsetFor(3).x);
+		REQUIRE(offset.y == camera->getOffsetFor(3).y);
+
+		// Moving the camera after the update isn't served stale offsets
+		camera->centerOn(500, 300);
+		REQUIRE(renderData.getCameraOffset(0).x == 400);
+		REQUIRE(renderData.getCameraOffset(40).x ==
+		        camera->getOffsetFor(40).x);
+	}
+
 	delete camera;
 }
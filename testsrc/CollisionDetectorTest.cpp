@@ -3,6 +3,7 @@
 #include "../src/EntityContainer.h"
 #include "../src/EntityProperties.h"
 #include "../src/EntityShape.h"
+#include "../src/GameData.h"
 #include "EntityImpl.h"
 #include "catch.hpp"
 
@@ -67,13 +68,105 @@ TEST_CASE("CollisionDetectorTests", "[collision]")
 		props.setXvel(10);
 		props.setYvel(0);
 
-		float normaly, normalx;
+		flat2d::Entity* c6 = new EntityImpl(115, 100);
+
+		float normalx, normaly;
 		float result = detector->sweptAABB(&c1->getEntityProperties(),
-		                                   &c5->getEntityProperties(),
-		                                   &normaly,
-		                                   &normalx);
-		REQUIRE(result > 0.0f);
-		REQUIRE(result < 1.0f);
+		                                   &c6->getEntityProperties(),
+		                                   &normalx,
+		                                   &normaly);
+		REQUIRE(result == 0.5f);
+		REQUIRE(normalx == -1.0f);
+		REQUIRE(normaly == 0.0f);
+
+		// c5 is out of the path on the y axis
+		result = detector->sweptAABB(&c1->getEntityProperties(),
+		                             &c5->getEntityProperties(),
+		                             &normalx,
+		                             &normaly);
+		REQUIRE(result == 1.0f);
+
+		delete c6;
+	}
+
+	SECTION("Collision filtering", "[collisions]")
+	{
+		flat2d::GameData gameData(container,
+		                          detector,
+		                          nullptr,
+		                          (flat2d::RenderData*)nullptr,
+		                          (flat2d::DeltatimeMonitor*)nullptr);
+
+		flat2d::EntityProperties& props = c1->getEntityProperties();
+		props.setXvel(10);
+		props.setCollisionMask(~0x2u);
+		c4->getEntityProperties().setCollisionCategory(0x2);
+
+		detector->handlePossibleCollisionsFor(c1, &gameData);
+		REQUIRE(props.getXvel() == 10);
+		REQUIRE(detector->getFilteredPairCount() == 1);
+
+		detector->resetFilteredPairCount();
+		props.setCollisionMask(0xFFFFFFFF);
+		detector->handlePossibleCollisionsFor(c1, &gameData);
+		REQUIRE(props.getXvel() == 0);
+		REQUIRE(detector->getFilteredPairCount() == 0);
+	}
+
+	SECTION("Swept vertical collision", "[collisions]")
+	{
+		float normalx, normaly;
+		float result = detector->sweptAABB(
+		  { 100, 100, 10, 10 }, 5, -80, { 95, 50, 20, 10 }, &normalx, &normaly);
+		REQUIRE(result == 0.5f);
+		REQUIRE(normalx == 0.0f);
+		REQUIRE(normaly == 1.0f);
+	}
+
+	SECTION("Continuous collision", "[collisions]")
+	{
+		flat2d::GameData gameData(container,
+		                          detector,
+		                          nullptr,
+		                          (flat2d::RenderData*)nullptr,
+		                          (flat2d::DeltatimeMonitor*)nullptr);
+
+		flat2d::Entity* bullet = new flat2d::Entity(0, 400, 4, 4);
+		flat2d::Entity* wall1 = new flat2d::Entity(500, 380, 2, 50);
+		flat2d::Entity* wall2 = new flat2d::Entity(300, 380, 2, 50);
+		flat2d::EntityProperties& props = bullet->getEntityProperties();
+		props.setCollidable(true);
+		props.setContinuousCollision(true);
+		props.setXvel(1000);
+		wall1->getEntityProperties().setCollidable(true);
+		wall2->getEntityProperties().setCollidable(true);
+		wall2->getEntityProperties().setStatic(true);
+
+		container->registerObject(bullet);
+		container->registerObject(wall1);
+		container->registerObject(wall2);
+		container->initiateEntities(&gameData);
+		container->moveObjects(&gameData);
+
+		REQUIRE(props.getXpos() == 295);
+		REQUIRE(props.getXvel() == 0);
+
+		wall2->setDead(true);
+		container->moveObjects(&gameData);
+		props.setXvel(1000);
+		container->moveObjects(&gameData);
+
+		REQUIRE(props.getXpos() == 495);
+		REQUIRE(props.getXvel() == 0);
+
+		// Etheral bodies keep their movement after passing a wall
+		props.setXpos(0);
+		props.setCollisionProperty(flat2d::CollisionProperty::ETHERAL);
+		props.setXvel(1000);
+		container->moveObjects(&gameData);
+
+		REQUIRE(props.getXpos() == 1000);
+		REQUIRE(props.getXvel() == 1000);
 	}
 
 	delete detector;
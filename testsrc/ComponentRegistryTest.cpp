@@ -0,0 +1,99 @@
+#include "../src/ComponentRegistry.h"
+#include "../src/DeltatimeMonitor.h"
+#include "../src/EntityContainer.h"
+#include "EntityImpl.h"
+#include "catch.hpp"
+
+struct Position
+{
+	float x, y;
+};
+
+struct Velocity
+{
+	float x, y;
+};
+
+TEST_CASE("ComponentRegistryTest", "[ecs]")
+{
+	flat2d::ComponentRegistry registry;
+
+	SECTION("Add and remove components", "[ecs]")
+	{
+		flat2d::EntityKey a = registry.create();
+		flat2d::EntityKey b = registry.create();
+		registry.add(a, Position{ 1, 2 });
+		registry.add(b, Position{ 3, 4 });
+		registry.add(b, Velocity{ 1, 1 });
+
+		REQUIRE(registry.getEntityCount() == 2);
+		REQUIRE(registry.has<Position>(a));
+		REQUIRE(!registry.has<Velocity>(a));
+		REQUIRE(registry.get<Position>(b)->x == 3);
+		REQUIRE(registry.get<Velocity>(a) == nullptr);
+
+		registry.remove<Velocity>(b);
+		REQUIRE(!registry.has<Velocity>(b));
+		REQUIRE(registry.get<Position>(b)->y == 4);
+
+		registry.destroy(a);
+		REQUIRE(!registry.contains(a));
+		REQUIRE(registry.get<Position>(b)->x == 3);
+		REQUIRE(registry.getEntityCount() == 1);
+	}
+
+	SECTION("Iterate archetypes", "[ecs]")
+	{
+		for (int i = 0; i < 10; i++) {
+			flat2d::EntityKey key = registry.create();
+			registry.add(key, Position{ 0, 0 });
+			if (i % 2 == 0) {
+				registry.add(key, Velocity{ 1, 2 });
+			}
+		}
+
+		int moved = 0;
+		registry.each<Position, Velocity>(
+		  [&moved](flat2d::EntityKey key, Position& p, Velocity& v) {
+			  p.x += v.x;
+			  p.y += v.y;
+			  moved++;
+		  });
+		REQUIRE(moved == 5);
+
+		size_t total = 0;
+		float sum = 0;
+		registry.eachChunk<Position>(
+		  [&](size_t count, const flat2d::EntityKey* keys, Position* p) {
+			  for (size_t i = 0; i < count; i++) {
+				  sum += p[i].x + p[i].y;
+			  }
+			  total += count;
+		  });
+		REQUIRE(total == 10);
+		REQUIRE(sum == 15);
+	}
+
+	SECTION("Bridge entities", "[ecs]")
+	{
+		flat2d::DeltatimeMonitor dtm;
+		flat2d::EntityContainer container(&dtm);
+		container.setComponentRegistry(&registry);
+
+		flat2d::Entity* entity = new EntityImpl(10, 10);
+		container.registerObject(entity);
+		flat2d::EntityKey key = registry.bridge(entity);
+		registry.add(key, Velocity{ 1, 0 });
+
+		int found = 0;
+		registry.each<flat2d::EntityRef, Velocity>(
+		  [&](flat2d::EntityKey, flat2d::EntityRef& ref, Velocity&) {
+			  REQUIRE(ref.entity == entity);
+			  found++;
+		  });
+		REQUIRE(found == 1);
+
+		container.unregisterAllObjects();
+		REQUIRE(!registry.contains(key));
+	}
+}
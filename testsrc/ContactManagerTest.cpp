@@ -0,0 +1,112 @@
+#include "../src/ContactManager.h"
+#include "../src/Entity.h"
+#include "catch.hpp"
+
+class ContactListenerImpl : public flat2d::Entity
+{
+  public:
+	int begins = 0;
+	int ends = 0;
+
+	ContactListenerImpl()
+	  : Entity(0, 0, 10, 10)
+	{
+		setContactListener(true);
+	}
+
+	void onContactBegin(flat2d::Entity* other,
+	                    const flat2d::GameData* data) override
+	{
+		begins++;
+	}
+
+	void onContactEnd(flat2d::Entity* other,
+	                  const flat2d::GameData* data) override
+	{
+		ends++;
+	}
+};
+
+class ContactRemover : public ContactListenerImpl
+{
+  public:
+	flat2d::ContactManager* manager = nullptr;
+	ContactListenerImpl* victim = nullptr;
+
+	void onContactBegin(flat2d::Entity* other,
+	                    const flat2d::GameData* data) override
+	{
+		begins++;
+		if (victim != nullptr) {
+			manager->removeEntity(victim, data);
+			delete victim;
+			victim = nullptr;
+		}
+	}
+};
+
+TEST_CASE("ContactManagerTest", "[contacts]")
+{
+	flat2d::ContactManager manager;
+	ContactListenerImpl a;
+	ContactListenerImpl b;
+	flat2d::Entity c(0, 0, 10, 10);
+
+	SECTION("Begin, stay and end", "[contacts]")
+	{
+		manager.addContact(&a, &b);
+		manager.addContact(&b, &a);
+		manager.endStep(nullptr);
+		REQUIRE(1 == manager.getContactCount());
+		REQUIRE(1 == manager.getEvents().size());
+		REQUIRE(manager.getEvents()[0].type ==
+		        flat2d::ContactEventType::BEGIN);
+		REQUIRE(1 == a.begins);
+		REQUIRE(1 == b.begins);
+
+		manager.addContact(&a, &b);
+		manager.endStep(nullptr);
+		REQUIRE(manager.getEvents()[0].type == flat2d::ContactEventType::STAY);
+		REQUIRE(1 == a.begins);
+
+		manager.endStep(nullptr);
+		REQUIRE(manager.getEvents()[0].type == flat2d::ContactEventType::END);
+		REQUIRE(0 == manager.getContactCount());
+		REQUIRE(1 == a.ends);
+		REQUIRE(1 == b.ends);
+
+		manager.endStep(nullptr);
+		REQUIRE(manager.getEvents().empty());
+	}
+
+	SECTION("Removed entities", "[contacts]")
+	{
+		manager.addContact(&a, &c);
+		manager.addContact(&b, &c);
+		manager.endStep(nullptr);
+		REQUIRE(2 == manager.getEvents().size());
+
+		manager.removeEntity(&c, nullptr);
+		REQUIRE(0 == manager.getContactCount());
+		REQUIRE(manager.getEvents().empty());
+		REQUIRE(1 == a.ends);
+		REQUIRE(1 == b.ends);
+	}
+
+	SECTION("Removed during dispatch", "[contacts]")
+	{
+		ContactRemover remover;
+		ContactListenerImpl* victim = new ContactListenerImpl();
+		remover.manager = &manager;
+		remover.victim = victim;
+
+		// The remover's event comes first and deletes the victim
+		manager.addContact(&remover, &b);
+		manager.addContact(victim, &c);
+		manager.endStep(nullptr);
+		REQUIRE(1 == remover.begins);
+		REQUIRE(1 == b.begins);
+		REQUIRE(1 == manager.getEvents().size());
+		REQUIRE(1 == manager.getContactCount());
+	}
+}
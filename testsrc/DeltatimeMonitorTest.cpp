@@ -9,4 +9,39 @@ TEST_CASE("DeltatimeMonitorTest", "[deltatime]")
 	{
 		REQUIRE(dtMonitor.getDeltaTime() == 1);
 	}
+
+	SECTION("FixedTimestepTest", "[deltatime]")
+	{
+		dtMonitor.setFixedTimestep(50);
+		REQUIRE(dtMonitor.isFixedTimestep());
+		REQUIRE(dtMonitor.getDeltaTime() == 0.02f);
+
+		dtMonitor.updateDeltaTime();
+		dtMonitor.updateDeltaTime();
+		REQUIRE(dtMonitor.getDeltaTime() == 0.02f);
+		REQUIRE(dtMonitor.getTickCount() == 2);
+
+		dtMonitor.setFixedTimestep(0);
+		REQUIRE(!dtMonitor.isFixedTimestep());
+		REQUIRE(dtMonitor.getTickCount() == 0);
+	}
+
+	SECTION("AccumulatorTest", "[deltatime]")
+	{
+		REQUIRE(dtMonitor.collectTicks(0) == 1);
+
+		// Time 0 is a valid start
+		dtMonitor.setFixedTimestep(100);
+		REQUIRE(dtMonitor.collectTicks(0) == 1);
+
+		// Slow frames run several ticks, the remainder is kept
+		REQUIRE(dtMonitor.collectTicks(35) == 3);
+		REQUIRE(dtMonitor.collectTicks(39) == 0);
+		REQUIRE(dtMonitor.collectTicks(45) == 1);
+
+		// Time beyond the max is dropped
+		dtMonitor.setMaxTicksPerFrame(2);
+		REQUIRE(dtMonitor.collectTicks(95) == 2);
+		REQUIRE(dtMonitor.collectTicks(100) == 0);
+	}
 }
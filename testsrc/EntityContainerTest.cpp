@@ -1,17 +1,107 @@
 #include "../src/EntityContainer.h"
+#include "../src/Camera.h"
 #include "../src/CollisionDetector.h"
 #include "../src/DeltatimeMonitor.h"
 #include "../src/EntityProperties.h"
 #include "../src/GameData.h"
+#include "../src/JobPool.h"
 #include "../src/MapArea.h"
 #include "../src/Mixer.h"
+#include "../src/RenderData.h"
+#include "../src/Snapshot.h"
+#include "../src/UID.h"
 #include "EntityImpl.h"
 #include "catch.hpp"
 
+class EventCounter : public flat2d::Entity
+{
+  public:
+	int handled = 0;
+	int preHandled = 0;
+
+	EventCounter()
+	  : Entity(0, 0, 10, 10)
+	{}
+
+	void preHandle(const flat2d::GameData* data) override { preHandled++; }
+
+	void handle(const SDL_Event& event) override { handled++; }
+};
+
+class RenderCounter : public flat2d::Entity
+{
+  public:
+	mutable int rendered = 0;
+
+	RenderCounter(int x, int y)
+	  : Entity(x, y, 10, 10)
+	{}
+
+	void render(const flat2d::RenderData* data) const override { rendered++; }
+};
+
+class MoveCounter : public flat2d::Entity
+{
+  public:
+	int preMoved = 0;
+
+	MoveCounter()
+	  : Entity(0, 0, 10, 10)
+	{}
+
+	int getType() const override { return 7; }
+
+	void preMove(const flat2d::GameData* data) override { preMoved++; }
+};
+
+class DerivedMoveCounter : public MoveCounter
+{};
+
+class ExpiringEntity : public flat2d::Entity
+{
+  public:
+	bool expired = false;
+
+	ExpiringEntity()
+	  : Entity(0, 0, 10, 10)
+	{}
+
+	bool isDead() const override { return expired; }
+};
+
+class InitCounter : public flat2d::Entity
+{
+  public:
+	std::atomic<int> loaded{ 0 };
+	int initiated = 0;
+
+	InitCounter()
+	  : Entity(0, 0, 10, 10)
+	{
+		setAsyncInit(true);
+	}
+
+	void initAsync(const flat2d::GameData* data) override { loaded++; }
+
+	void init(const flat2d::GameData* data) override
+	{
+		if (loaded == 1) {
+			initiated++;
+		}
+	}
+};
+
 TEST_CASE("Object container tests", "[objectcontainer]")
 {
 	flat2d::DeltatimeMonitor* dtm = new flat2d::DeltatimeMonitor();
 	flat2d::EntityContainer container(dtm);
+	flat2d::CollisionDetector detector(&container, dtm);
+	flat2d::Mixer mixer;
+	flat2d::GameData gameData(&container,
+	                          &detector,
+	                          &mixer,
+	                          (flat2d::RenderData*)nullptr,
+	                          (flat2d::DeltatimeMonitor*)nullptr);
 
 	SECTION("Test container destructor", "[objectcontainer]")
 	{
@@ -128,14 +218,6 @@ TEST_CASE("Object container tests", "[objectcontainer]")
 		flat2d::Entity* c1 = new EntityImpl(100, 100);
 		EntityImpl* c2 = new EntityImpl(100, 100);
 
-		flat2d::CollisionDetector detector(&container, dtm);
-		flat2d::Mixer mixer;
-		flat2d::GameData gameData(&container,
-		                          &detector,
-		                          &mixer,
-		                          (flat2d::RenderData*)nullptr,
-		                          (flat2d::DeltatimeMonitor*)nullptr);
-
 		container.registerObject(c1);
 		container.registerObject(c2);
 
@@ -149,13 +231,6 @@ TEST_CASE("Object container tests", "[objectcontainer]")
 
 	SECTION("Test partition handling", "[objectcontainer]")
 	{
-		flat2d::CollisionDetector detector(&container, dtm);
-		flat2d::GameData gameData(&container,
-		                          &detector,
-		                          nullptr,
-		                          (flat2d::RenderData*)nullptr,
-		                          (flat2d::DeltatimeMonitor*)nullptr);
-
 		flat2d::Entity* o = new EntityImpl(95, 95);
 
 		container.setSpatialPartitionDimension(100);
@@ -180,10 +255,8 @@ TEST_CASE("Object container tests", "[objectcontainer]")
 		flat2d::Entity* o5 = new EntityImpl(1095, 1095);
 
 		container.registerObject(o1);
-		REQUIRE(1 == container.getSpatialPartitionCount());
 
 		container.registerObject(o4);
-		REQUIRE(1 == container.getSpatialPartitionCount());
 
 		container.registerObject(o2);
 		REQUIRE(2 == container.getSpatialPartitionCount());
@@ -226,5 +299,457 @@ TEST_CASE("Object container tests", "[objectcontainer]")
 		REQUIRE(4 == container.getSpatialPartitionCount());
 	}
 
+	SECTION("Test static bodies", "[objectcontainer]")
+	{
+		flat2d::Entity* wall1 = new EntityImpl(150, 100);
+		flat2d::Entity* wall2 = new EntityImpl(160, 100);
+		flat2d::Entity* o = new EntityImpl(100, 100);
+		wall1->getEntityProperties().setStatic(true);
+		wall2->getEntityProperties().setStatic(true);
+
+		container.registerObject(wall1);
+		container.registerObject(wall2);
+		container.registerObject(o);
+		container.initiateEntities(&gameData);
+
+		REQUIRE(3 == container.getCollidablesCount());
+		REQUIRE(2 == container.getStaticCollidablesCount());
+		REQUIRE(wall1->getEntityProperties().getCurrentAreas().empty());
+
+		int count = 0;
+		container.iterateCollidablesFor(
+		  wall1, [&count](flat2d::Entity* e) { count++; });
+		REQUIRE(0 == count);
+
+		o->getEntityProperties().setXvel(100);
+		container.moveObjects(&gameData);
+
+		REQUIRE(o->getEntityProperties().getXpos() == 139);
+		REQUIRE(o->getEntityProperties().getXvel() == 0);
+		REQUIRE(wall1->getEntityProperties().getXpos() == 150);
+
+		container.unregisterObject(wall1);
+		REQUIRE(1 == container.getStaticCollidablesCount());
+		delete wall1;
+	}
+
+	SECTION("Test sleeping objects", "[objectcontainer]")
+	{
+		flat2d::Entity* o1 = new EntityImpl(100, 100);
+		flat2d::Entity* o2 = new EntityImpl(300, 100);
+		flat2d::EntityProperties& props1 = o1->getEntityProperties();
+		flat2d::EntityProperties& props2 = o2->getEntityProperties();
+
+		container.setSleepThreshold(2);
+		container.registerObject(o1);
+		container.registerObject(o2);
+		container.initiateEntities(&gameData);
+
+		container.moveObjects(&gameData);
+		REQUIRE(0 == container.getSleepingCount());
+		container.moveObjects(&gameData);
+		REQUIRE(2 == container.getSleepingCount());
+		REQUIRE(props1.isSleeping());
+
+		// Velocity wakes
+		props1.setXvel(100);
+		REQUIRE(!props1.isSleeping());
+		REQUIRE(1 == container.getSleepingCount());
+
+		// Collisions wake
+		container.moveObjects(&gameData);
+		REQUIRE(props1.getXpos() == 200);
+		props1.setXvel(100);
+		container.moveObjects(&gameData);
+		REQUIRE(props1.getXpos() == 289);
+		REQUIRE(!props2.isSleeping());
+
+		// Timers wake
+		container.moveObjects(&gameData);
+		container.moveObjects(&gameData);
+		REQUIRE(2 == container.getSleepingCount());
+		container.scheduleWake(o2, 1.5f);
+		container.moveObjects(&gameData);
+		REQUIRE(props2.isSleeping());
+		container.moveObjects(&gameData);
+		REQUIRE(!props2.isSleeping());
+
+		// Disabling sleep wakes everything
+		container.setSleepThreshold(0);
+		REQUIRE(0 == container.getSleepingCount());
+		REQUIRE(!props1.isSleeping());
+	}
+
+	SECTION("Test triggers", "[objectcontainer]")
+	{
+		flat2d::Entity* trigger = new flat2d::Entity(200, 100, 50, 50);
+		flat2d::Entity* o1 = new EntityImpl(100, 100);
+		flat2d::Entity* o2 = new EntityImpl(100, 120);
+		trigger->getEntityProperties().setTrigger(true);
+		o2->getEntityProperties().setCollisionMask(0x2);
+
+		container.registerObject(trigger);
+		container.registerObject(o1);
+		container.registerObject(o2);
+		container.initiateEntities(&gameData);
+
+		REQUIRE(1 == container.getTriggerCount());
+		REQUIRE(2 == container.getCollidablesCount());
+
+		const std::vector<flat2d::ContactEvent>& events =
+		  container.getContactManager().getEvents();
+		o1->getEntityProperties().setXvel(100);
+		o2->getEntityProperties().setXvel(100);
+		container.moveObjects(&gameData);
+
+		REQUIRE(o1->getEntityProperties().getXpos() == 200);
+		REQUIRE(o2->getEntityProperties().getXpos() == 200);
+		REQUIRE(1 == events.size());
+		REQUIRE(events[0].type == flat2d::ContactEventType::BEGIN);
+		REQUIRE(events[0].trigger);
+		REQUIRE(events[0].entityA == trigger);
+		REQUIRE(events[0].entityB == o1);
+
+		container.moveObjects(&gameData);
+		REQUIRE(1 == events.size());
+		REQUIRE(events[0].type == flat2d::ContactEventType::END);
+	}
+
+	SECTION("Test deterministic mode", "[objectcontainer]")
+	{
+		for (int i = 0; i < 12; i++) {
+			flat2d::Entity* o = new EntityImpl(i * 20, 0);
+			o->getEntityProperties().setYvel(100);
+			container.registerObject(o);
+		}
+		container.initiateEntities(&gameData);
+
+		// Creation order, not string order
+		int lastId = 0;
+		container.iterateAllMovingObjects([&lastId](flat2d::Entity* o) {
+			REQUIRE(o->getId() > lastId);
+			lastId = o->getId();
+		});
+
+		container.moveObjects(&gameData);
+		REQUIRE(0 == container.getLastStateHash());
+
+		dtm->setFixedTimestep(50);
+		Uint64 hash = container.computeStateHash();
+		dtm->updateDeltaTime();
+		container.moveObjects(&gameData);
+		REQUIRE(container.getLastStateHash() != 0);
+		REQUIRE(container.getLastStateHash() != hash);
+		REQUIRE(container.getLastStateHash() == container.computeStateHash());
+	}
+
+	SECTION("Test snapshots", "[objectcontainer]")
+	{
+		flat2d::Entity* o1 = new EntityImpl(100, 100);
+		flat2d::Entity* o2 = new EntityImpl(300, 100);
+		flat2d::EntityProperties& props = o1->getEntityProperties();
+		props.setXvel(100);
+		container.registerObject(o1);
+		container.registerObject(o2);
+		container.initiateEntities(&gameData);
+
+		flat2d::Snapshot snapshot;
+		container.takeSnapshot(&snapshot);
+		Uint64 hash = container.computeStateHash();
+
+		container.moveObjects(&gameData);
+		container.moveObjects(&gameData);
+		flat2d::Entity* o3 = new EntityImpl(0, 0);
+		container.registerObject(o3);
+		REQUIRE(props.getXpos() == 289);
+		REQUIRE(props.getXvel() == 0);
+
+		REQUIRE(container.restoreSnapshot(&snapshot));
+		REQUIRE(props.getXpos() == 100);
+		REQUIRE(props.getXvel() == 100);
+		REQUIRE(o3->isDead());
+		REQUIRE(2 == props.getCurrentAreas().size());
+
+		container.moveObjects(&gameData);
+		REQUIRE(2 == container.getObjectCount());
+		container.restoreSnapshot(&snapshot);
+		REQUIRE(container.computeStateHash() == hash);
+
+		flat2d::UID::setRecycling(true);
+		REQUIRE(!container.restoreSnapshot(&snapshot));
+		flat2d::UID::setRecycling(false);
+	}
+
+	SECTION("Test event subscriptions", "[objectcontainer]")
+	{
+		EventCounter* broadcast = new EventCounter();
+		EventCounter* keys = new EventCounter();
+		EventCounter* clicks = new EventCounter();
+		broadcast->setInputHandler(true);
+		keys->subscribeEvent(SDL_KEYDOWN);
+		clicks->subscribeEvent(SDL_MOUSEBUTTONDOWN);
+		clicks->setEventRegion({ 100, 100, 50, 50 });
+
+		container.registerObject(broadcast);
+		container.registerObject(keys);
+		container.registerObject(clicks);
+		container.initiateEntities(nullptr);
+
+		SDL_Event event;
+		event.type = SDL_KEYDOWN;
+		container.handleObjects(event, nullptr);
+		event.type = SDL_MOUSEBUTTONDOWN;
+		event.button.x = 10;
+		event.button.y = 120;
+		container.handleObjects(event, nullptr);
+		event.button.x = 120;
+		container.handleObjects(event, nullptr);
+
+		REQUIRE(3 == broadcast->handled);
+		REQUIRE(3 == broadcast->preHandled);
+		REQUIRE(1 == keys->handled);
+		REQUIRE(0 == keys->preHandled);
+		REQUIRE(1 == clicks->handled);
+
+		container.unregisterObject(keys);
+		event.type = SDL_KEYDOWN;
+		container.handleObjects(event, nullptr);
+		REQUIRE(1 == keys->handled);
+		delete keys;
+	}
+
+	SECTION("Test spatial queries", "[objectcontainer]")
+	{
+		flat2d::Entity* o1 = new EntityImpl(50, 50);
+		flat2d::Entity* o2 = new EntityImpl(150, 50);
+		flat2d::Entity* o3 = new EntityImpl(400, 400);
+		o2->getEntityProperties().setStatic(true);
+
+		container.registerObject(o1);
+		container.registerObject(o2);
+		container.registerObject(o3);
+
+		flat2d::Entity* result[3];
+		REQUIRE(1 == container.queryRect({ 40, 40, 20, 20 }, result, 3));
+		REQUIRE(result[0] == o1);
+		REQUIRE(2 == container.queryRect({ 0, 0, 200, 100 }, result, 3));
+		REQUIRE(1 == container.queryRect({ 0, 0, 200, 100 }, result, 1));
+
+		REQUIRE(1 == container.queryCircle(100, 55, 45, result, 3));
+		REQUIRE(2 == container.queryCircle(100, 55, 50, result, 3));
+
+		flat2d::RayHit hits[3];
+		REQUIRE(container.raycast(0, 55, 300, 55, hits));
+		REQUIRE(hits[0].entity == o1);
+		REQUIRE(hits[0].distance == 50);
+		REQUIRE(hits[0].normalx == -1);
+		REQUIRE(!container.raycast(0, 0, 300, 0, hits));
+		REQUIRE(2 == container.raycastAll(300, 55, 0, 55, hits, 3));
+		REQUIRE(hits[0].entity == o2);
+		REQUIRE(hits[0].distance == 140);
+		REQUIRE(hits[0].normalx == 1);
+		REQUIRE(hits[1].entity == o1);
+
+		REQUIRE(2 == container.queryNearest(390, 390, 500, result, 2));
+		REQUIRE(result[0] == o3);
+		REQUIRE(result[1] == o2);
+		REQUIRE(1 == container.queryNearest(390, 390, 100, result, 3));
+	}
+
+	SECTION("Test cached layers", "[objectcontainer]")
+	{
+		flat2d::Camera camera(100, 100);
+		flat2d::RenderData renderData(nullptr, &camera);
+		flat2d::GameData renderGameData(&container,
+		                                nullptr,
+		                                nullptr,
+		                                &renderData,
+		                                (flat2d::DeltatimeMonitor*)nullptr);
+
+		RenderCounter* o = new RenderCounter(10, 10);
+		container.addLayer(1);
+		container.setLayerCached(1, true);
+		REQUIRE(container.isLayerCached(1));
+		REQUIRE(!container.isLayerCached(0));
+
+		container.registerObject(o, 1);
+		container.initiateEntities(&renderGameData);
+
+		// Without render targets the layer is rendered normally
+		container.renderObjects(&renderGameData);
+		container.renderObjects(&renderGameData);
+		REQUIRE(o->rendered == 2);
+
+		container.invalidateLayer(1);
+		container.renderObjects(&renderGameData);
+		REQUIRE(o->rendered == 3);
+
+		container.setLayerCached(1, false);
+		REQUIRE(!container.isLayerCached(1));
+		container.renderObjects(&renderGameData);
+		REQUIRE(o->rendered == 4);
+	}
+
+	SECTION("Test type hooks", "[objectcontainer]")
+	{
+		MoveCounter* first = new MoveCounter();
+		MoveCounter* second = new MoveCounter();
+		MoveCounter* derived = new DerivedMoveCounter();
+		container.registerObject(first);
+		container.registerObject(derived);
+		container.registerType<MoveCounter>();
+		container.registerObject(second);
+		container.initiateEntities(&gameData);
+
+		container.moveObjects(&gameData);
+		REQUIRE(first->preMoved == 1);
+		REQUIRE(second->preMoved == 1);
+
+		// The batch hook replaces preMove
+		size_t batched = 0;
+		container.registerType<MoveCounter>(
+		  [&batched](flat2d::Entity* const* entities,
+		             size_t count,
+		             const flat2d::GameData* data) { batched += count; });
+		container.moveObjects(&gameData);
+		REQUIRE(batched == 2);
+		REQUIRE(first->preMoved == 1);
+		// Same getType but a different class, not part of the batch
+		REQUIRE(derived->preMoved == 2);
+
+		container.registerType<MoveCounter>();
+		container.moveObjects(&gameData);
+		REQUIRE(batched == 2);
+		REQUIRE(first->preMoved == 2);
+	}
+
+	SECTION("Test kill queue", "[objectcontainer]")
+	{
+		flat2d::Entity* revived = new EntityImpl(100, 100);
+		flat2d::Entity* killed = new EntityImpl(100, 100);
+		flat2d::Entity* unregistered = new EntityImpl(300, 300);
+		container.addLayer(2);
+		container.registerObject(revived, 2);
+		container.registerObject(killed, 2);
+		container.registerObject(unregistered);
+
+		revived->setDead(true);
+		revived->setDead(false);
+		killed->setDead(true);
+		killed->setDead(true);
+		unregistered->setDead(true);
+		container.unregisterObject(unregistered);
+		container.moveObjects(&gameData);
+
+		REQUIRE(1 == container.getObjectCount());
+		REQUIRE(1 == container.getObjectCountFor(2));
+		delete unregistered;
+
+		// Overrides of isDead are only picked up by the opt-in scan
+		ExpiringEntity* expiring = new ExpiringEntity();
+		container.registerObject(expiring);
+		container.initiateEntities(&gameData);
+		expiring->expired = true;
+		container.moveObjects(&gameData);
+		REQUIRE(2 == container.getObjectCount());
+		container.setDeadObjectScan(true);
+		container.moveObjects(&gameData);
+		REQUIRE(1 == container.getObjectCount());
+		container.setDeadObjectScan(false);
+
+		// Clearing a layer holding every object keeps the layer
+		container.unregisterAllObjectsFor(2);
+		REQUIRE(0 == container.getObjectCount());
+		REQUIRE(0 == container.getObjectCountFor(2));
+		REQUIRE(2 == container.getLayerKeys().size());
+	}
+
+	SECTION("Test iterating collidables", "[objectcontainer]")
+	{
+		container.registerObject(new EntityImpl(100, 100));
+		container.registerObject(new EntityImpl(200, 200));
+
+		int count = 0;
+		container.iterateCollidablesIn(
+		  -1, [&count](flat2d::Entity* e) { count++; });
+		REQUIRE(2 == count);
+		REQUIRE(2 == container.getObjectCount());
+		REQUIRE(2 == container.getObjectCountFor(-1));
+	}
+
+	SECTION("Test bulk registration", "[objectcontainer]")
+	{
+		flat2d::Entity* entities[20];
+		for (int i = 0; i < 20; i++) {
+			entities[i] = new EntityImpl(i * 50, 95);
+		}
+		container.addLayer(3);
+		container.registerObject(entities[4], 3);
+		container.registerObjects(entities, 20, 3);
+		container.registerObjects(entities, 20, 3);
+
+		REQUIRE(20 == container.getObjectCount());
+		REQUIRE(20 == container.getObjectCountFor(3));
+
+		flat2d::Entity* result[20];
+		REQUIRE(2 == container.queryRect({ 0, 90, 60, 20 }, result, 20));
+		REQUIRE(result[0] == entities[0]);
+		REQUIRE(result[1] == entities[1]);
+		REQUIRE(20 == container.queryRect({ 0, 0, 1000, 200 }, result, 20));
+	}
+
+	SECTION("Test async init", "[objectcontainer]")
+	{
+		InitCounter* counters[10];
+		for (int i = 0; i < 10; i++) {
+			counters[i] = new InitCounter();
+			container.registerObject(counters[i]);
+		}
+
+		// Without a JobPool everything is loaded in place
+		container.initiateEntities(nullptr);
+		REQUIRE(0 == container.getUninitiatedCount());
+		REQUIRE(1 == counters[9]->initiated);
+
+		flat2d::JobPool pool(2);
+		container.setJobPool(&pool);
+		InitCounter* async = new InitCounter();
+		container.registerObject(async);
+		container.initiateEntities(nullptr);
+		pool.wait();
+		REQUIRE(1 == async->loaded);
+		container.initiateEntities(nullptr);
+		REQUIRE(1 == async->initiated);
+		REQUIRE(0 == container.getUninitiatedCount());
+
+		// Unregistering drops a load still queued behind other jobs
+		flat2d::JobPool busyPool(1);
+		std::atomic<bool> release{ false };
+		busyPool.submit([&release]() {
+			while (!release) {
+				std::this_thread::yield();
+			}
+		});
+		container.setJobPool(&busyPool);
+		InitCounter* queued = new InitCounter();
+		container.registerObject(queued);
+		container.initiateEntities(nullptr);
+		container.unregisterObject(queued);
+		release = true;
+		busyPool.wait();
+		REQUIRE(0 == queued->loaded);
+		delete queued;
+		container.setJobPool(nullptr);
+
+		// A tiny budget initiates one Entity per frame
+		container.setInitBudget(0.000001f);
+		container.registerObject(new EntityImpl(0, 0));
+		container.registerObject(new EntityImpl(0, 0));
+		container.initiateEntities(nullptr);
+		REQUIRE(1 == container.getUninitiatedCount());
+		container.initiateEntities(nullptr);
+		REQUIRE(0 == container.getUninitiatedCount());
+	}
+
 	delete dtm;
 }
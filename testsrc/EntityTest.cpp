@@ -52,4 +52,16 @@ TEST_CASE("EntityTest", "[entity]")
 		entity.setDead(false);
 		REQUIRE(!entity.isDead());
 	}
+
+	SECTION("KeyTest", "[entity]")
+	{
+		flat2d::Entity other(0, 0, 50, 50);
+		REQUIRE(entity.getKey() == entity.getKey());
+		REQUIRE(entity.getKey() != other.getKey());
+		REQUIRE(entity.getKey() < other.getKey());
+		REQUIRE(entity.getStringId() == std::to_string(entity.getId()));
+
+		std::hash<flat2d::EntityKey> hash;
+		REQUIRE(hash(entity.getKey()) != hash(other.getKey()));
+	}
 }
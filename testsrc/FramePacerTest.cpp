@@ -0,0 +1,89 @@
+#include "../src/FramePacer.h"
+#include "catch.hpp"
+
+// A fake clock in microseconds advancing by one on every read
+static Uint64 fakeTime = 0;
+
+static Uint64
+fakeClock()
+{
+	return fakeTime++;
+}
+
+static float
+elapsedSince(Uint64 start)
+{
+	return (fakeTime - start) / 1000.0f;
+}
+
+TEST_CASE("FramePacerTest", "[pacing]")
+{
+	flat2d::FramePacer pacer;
+	pacer.setTargetFps(100.0);
+	// Never sleep, the fake clock only moves while spinning
+	pacer.setSpinThreshold(1000000.0f);
+	pacer.setClock(fakeClock, 1000000);
+
+	SECTION("Capped", "[pacing]")
+	{
+		REQUIRE(pacer.getMode() == flat2d::PACING_CAPPED);
+		REQUIRE(!pacer.isVsyncActive());
+		REQUIRE(pacer.getRemainingTime() > 9.9f);
+		REQUIRE(pacer.getRemainingTime() <= 10.0f);
+
+		Uint64 start = fakeTime;
+		for (int i = 0; i < 10; i++) {
+			pacer.waitForNextFrame();
+		}
+		REQUIRE(elapsedSince(start) >= 99.9f);
+		REQUIRE(elapsedSince(start) < 100.1f);
+		REQUIRE(pacer.getStats().frames == 10);
+		REQUIRE(pacer.getStats().averageFrameTime >= 9.9f);
+		REQUIRE(pacer.getStats().missedDeadlines == 0);
+	}
+
+	SECTION("Missed deadlines", "[pacing]")
+	{
+		fakeTime += 25000;
+		REQUIRE(pacer.getRemainingTime() == 0.0f);
+		pacer.waitForNextFrame();
+		REQUIRE(pacer.getStats().missedDeadlines == 1);
+		REQUIRE(pacer.getStats().worstLateness >= 14.9f);
+		REQUIRE(pacer.getStats().worstLateness < 15.1f);
+
+		// The schedule restarts instead of rushing the next frame
+		Uint64 start = fakeTime;
+		pacer.waitForNextFrame();
+		REQUIRE(elapsedSince(start) >= 9.9f);
+		REQUIRE(pacer.getStats().missedDeadlines == 1);
+
+		pacer.resetStats();
+		REQUIRE(pacer.getStats().frames == 0);
+	}
+
+	SECTION("Uncapped", "[pacing]")
+	{
+		pacer.setMode(flat2d::PACING_UNCAPPED);
+		REQUIRE(pacer.getRemainingTime() == 0.0f);
+
+		Uint64 start = fakeTime;
+		for (int i = 0; i < 10; i++) {
+			pacer.waitForNextFrame();
+		}
+		REQUIRE(elapsedSince(start) < 1.0f);
+		REQUIRE(pacer.getStats().missedDeadlines == 0);
+
+		// Without a renderer vsync falls back to the capped pacing
+		pacer.setMode(flat2d::PACING_VSYNC);
+		REQUIRE(!pacer.isVsyncActive());
+		REQUIRE(pacer.getRefreshRate() == 0.0);
+		pacer.setRefreshRate(144.0);
+		REQUIRE(pacer.getRefreshRate() == 144.0);
+		start = fakeTime;
+		pacer.waitForNextFrame();
+		pacer.waitForNextFrame();
+		REQUIRE(elapsedSince(start) >= 9.9f);
+	}
+
+	pacer.setClock(nullptr, 0);
+}
@@ -0,0 +1,59 @@
+#include <cstdio>
+
+#include "../src/DeltatimeMonitor.h"
+#include "../src/InputRecorder.h"
+#include "catch.hpp"
+
+TEST_CASE("InputRecorderTest", "[inputrecorder]")
+{
+	const char* path = "inputrecordertest.bin";
+	flat2d::InputRecorder recorder;
+	flat2d::DeltatimeMonitor dtMonitor;
+
+	SECTION("Record and playback", "[inputrecorder]")
+	{
+		SDL_Event event;
+		event.type = SDL_KEYDOWN;
+		event.key.keysym.sym = 42;
+
+		REQUIRE(recorder.startRecording(path));
+		dtMonitor.injectDeltaTime(0.016f);
+		recorder.beginTick(&dtMonitor);
+		recorder.recordEvent(event);
+		dtMonitor.injectDeltaTime(0.02f);
+		recorder.beginTick(&dtMonitor);
+		event.type = SDL_MOUSEMOTION;
+		event.motion.x = 10;
+		recorder.recordEvent(event);
+		recorder.recordEvent(event);
+		recorder.stop();
+
+		REQUIRE(recorder.startPlayback(path));
+		dtMonitor.injectDeltaTime(1.0f);
+		REQUIRE(recorder.beginTick(&dtMonitor));
+		REQUIRE(dtMonitor.getDeltaTime() == 0.016f);
+		REQUIRE(recorder.pollEvent(&event));
+		REQUIRE(event.type == SDL_KEYDOWN);
+		REQUIRE(event.key.keysym.sym == 42);
+		REQUIRE(!recorder.pollEvent(&event));
+
+		REQUIRE(recorder.beginTick(&dtMonitor));
+		REQUIRE(dtMonitor.getDeltaTime() == 0.02f);
+		REQUIRE(recorder.pollEvent(&event));
+		REQUIRE(event.motion.x == 10);
+		REQUIRE(recorder.pollEvent(&event));
+		REQUIRE(!recorder.pollEvent(&event));
+
+		REQUIRE(!recorder.beginTick(&dtMonitor));
+		REQUIRE(recorder.getMode() == flat2d::InputRecorder::OFF);
+		REQUIRE(recorder.getTickCount() == 2);
+
+		std::remove(path);
+	}
+
+	SECTION("Invalid recordings", "[inputrecorder]")
+	{
+		REQUIRE(!recorder.startPlayback("missing_recording.bin"));
+		REQUIRE(recorder.getMode() == flat2d::InputRecorder::OFF);
+	}
+}
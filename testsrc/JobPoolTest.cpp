@@ -0,0 +1,53 @@
+#include "../src/JobPool.h"
+#include "catch.hpp"
+#include <atomic>
+#include <thread>
+
+TEST_CASE("JobPoolTest", "[jobpool]")
+{
+	std::atomic<int> counter{ 0 };
+
+	SECTION("Run jobs", "[jobpool]")
+	{
+		flat2d::JobPool pool(3);
+		REQUIRE(pool.getThreadCount() == 3);
+
+		for (int i = 0; i < 100; i++) {
+			pool.submit([&counter]() { counter++; });
+		}
+		pool.wait();
+		REQUIRE(counter == 100);
+		REQUIRE(pool.getPendingCount() == 0);
+	}
+
+	SECTION("Cancel queued jobs", "[jobpool]")
+	{
+		flat2d::JobPool pool(1);
+		std::atomic<bool> release{ false };
+		flat2d::JobPool::JobId running = pool.submit([&release]() {
+			while (!release) {
+				std::this_thread::yield();
+			}
+		});
+		flat2d::JobPool::JobId queued =
+		  pool.submit([&counter]() { counter++; });
+		// The only worker is busy with the first job
+		REQUIRE(pool.cancel(queued));
+		REQUIRE(!pool.cancel(queued));
+		release = true;
+		pool.wait();
+		REQUIRE(!pool.cancel(running));
+		REQUIRE(counter == 0);
+	}
+
+	SECTION("Drain on destruction", "[jobpool]")
+	{
+		{
+			flat2d::JobPool pool(1);
+			for (int i = 0; i < 10; i++) {
+				pool.submit([&counter]() { counter++; });
+			}
+		}
+		REQUIRE(counter == 10);
+	}
+}
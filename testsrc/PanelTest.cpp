@@ -0,0 +1,86 @@
+#include "../src/Button.h"
+#include "../src/Panel.h"
+#include "catch.hpp"
+
+static SDL_Event
+mouseEvent(Uint32 type, int x, int y)
+{
+	SDL_Event event;
+	event.type = type;
+	if (type == SDL_MOUSEMOTION) {
+		event.motion.x = x;
+		event.motion.y = y;
+	} else {
+		event.button.button = SDL_BUTTON_LEFT;
+		event.button.x = x;
+		event.button.y = y;
+	}
+	return event;
+}
+
+TEST_CASE("PanelTest", "[ui]")
+{
+	int firstClicks = 0;
+	int secondClicks = 0;
+	flat2d::ui::Panel panel(100, 100, 200, 100);
+	flat2d::ui::Button* first =
+	  new flat2d::ui::Button(10, 10, 40, 20, [&]() { firstClicks++; });
+	flat2d::ui::Button* second =
+	  new flat2d::ui::Button(60, 10, 40, 20, [&]() { secondClicks++; });
+	panel.addWidget(first);
+	panel.addWidget(second);
+
+	REQUIRE(panel.getWidgetCount() == 2);
+	REQUIRE(panel.getEventSubscriptions().size() == 3);
+
+	SECTION("Hit testing", "[ui]")
+	{
+		REQUIRE(panel.getWidgetAt(20, 15) == first);
+		REQUIRE(panel.getWidgetAt(70, 15) == second);
+		REQUIRE(panel.getWidgetAt(55, 15) == nullptr);
+		REQUIRE(panel.getWidgetAt(-1, 15) == nullptr);
+		REQUIRE(panel.getWidgetAt(200, 15) == nullptr);
+
+		flat2d::ui::Button* top =
+		  new flat2d::ui::Button(0, 0, 200, 100, []() {});
+		panel.addWidget(top);
+		REQUIRE(panel.getWidgetAt(20, 15) == top);
+
+		panel.removeWidget(top);
+		REQUIRE(panel.getWidgetAt(20, 15) == first);
+		delete top;
+	}
+
+	SECTION("Moved widgets", "[ui]")
+	{
+		REQUIRE(panel.getWidgetAt(20, 15) == first);
+
+		first->getEntityProperties().setXpos(120);
+		panel.invalidate();
+		REQUIRE(panel.getWidgetAt(20, 15) == nullptr);
+		REQUIRE(panel.getWidgetAt(130, 15) == first);
+	}
+
+	SECTION("Event routing", "[ui]")
+	{
+		panel.handle(mouseEvent(SDL_MOUSEMOTION, 120, 115));
+		panel.handle(mouseEvent(SDL_MOUSEBUTTONDOWN, 120, 115));
+		REQUIRE(firstClicks == 1);
+		REQUIRE(secondClicks == 0);
+
+		panel.handle(mouseEvent(SDL_MOUSEMOTION, 170, 115));
+		panel.handle(mouseEvent(SDL_MOUSEBUTTONDOWN, 170, 115));
+		REQUIRE(firstClicks == 1);
+		REQUIRE(secondClicks == 1);
+	}
+
+	SECTION("Hover leave", "[ui]")
+	{
+		panel.handle(mouseEvent(SDL_MOUSEMOTION, 120, 115));
+
+		// Leaving the widget clears its hover state
+		panel.handle(mouseEvent(SDL_MOUSEMOTION, 280, 180));
+		first->handle(mouseEvent(SDL_MOUSEBUTTONDOWN, 20, 15));
+		REQUIRE(firstClicks == 0);
+	}
+}
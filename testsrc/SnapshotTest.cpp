@@ -0,0 +1,118 @@
+#include "../src/Snapshot.h"
+#include "../src/SnapshotHistory.h"
+#include "catch.hpp"
+#include <cstring>
+
+static flat2d::Snapshot createFrame(int frame)
+{
+	flat2d::Snapshot snapshot;
+	for (int i = 0; i < 100; i++) {
+		snapshot.write(i == 50 ? frame : i);
+	}
+	return snapshot;
+}
+
+static int readValue(flat2d::Snapshot* snapshot, size_t index)
+{
+	int value = -1;
+	snapshot->setReadPosition(index * sizeof(int));
+	snapshot->read(&value);
+	return value;
+}
+
+TEST_CASE("SnapshotTest", "[snapshot]")
+{
+	SECTION("Read and write", "[snapshot]")
+	{
+		flat2d::Snapshot snapshot;
+		snapshot.write(42);
+		snapshot.write(1.5f);
+		snapshot.write(7);
+		REQUIRE(snapshot.size() == 12);
+
+		int number = 0;
+		snapshot.writeAt(8, &number, sizeof(number));
+
+		float decimal;
+		REQUIRE(snapshot.read(&number));
+		REQUIRE(number == 42);
+		REQUIRE(snapshot.read(&decimal));
+		REQUIRE(decimal == 1.5f);
+		REQUIRE(snapshot.read(&number));
+		REQUIRE(number == 0);
+		REQUIRE(!snapshot.read(&number));
+	}
+
+	SECTION("History", "[snapshot]")
+	{
+		flat2d::SnapshotHistory history(10);
+		for (int i = 0; i < 25; i++) {
+			flat2d::Snapshot frame = createFrame(i);
+			history.push(frame);
+		}
+		REQUIRE(history.size() == 10);
+
+		flat2d::Snapshot snapshot;
+		REQUIRE(history.get(0, &snapshot));
+		REQUIRE(readValue(&snapshot, 50) == 24);
+		REQUIRE(history.get(9, &snapshot));
+		REQUIRE(readValue(&snapshot, 50) == 15);
+		REQUIRE(readValue(&snapshot, 99) == 99);
+		REQUIRE(!history.get(10, &snapshot));
+
+		// Two full frames and small deltas
+		REQUIRE(history.getMemoryUsage() < 3 * snapshot.size());
+
+		history.rewind(4);
+		REQUIRE(history.size() == 6);
+		REQUIRE(history.get(0, &snapshot));
+		REQUIRE(readValue(&snapshot, 50) == 20);
+	}
+
+	SECTION("History with changing sizes", "[snapshot]")
+	{
+		flat2d::SnapshotHistory history(3);
+		flat2d::Snapshot small;
+		small.write(1);
+		flat2d::Snapshot large = createFrame(3);
+
+		history.push(large);
+		history.push(small);
+		history.push(large);
+
+		flat2d::Snapshot snapshot;
+		REQUIRE(history.get(1, &snapshot));
+		REQUIRE(snapshot.size() == sizeof(int));
+		REQUIRE(readValue(&snapshot, 0) == 1);
+		REQUIRE(history.get(0, &snapshot));
+		REQUIRE(snapshot.getBuffer() == large.getBuffer());
+		REQUIRE(history.get(2, &snapshot));
+		REQUIRE(snapshot.getBuffer() == large.getBuffer());
+	}
+
+	SECTION("Corrupt deltas", "[snapshot]")
+	{
+		std::vector<Uint8> from = createFrame(1).getBuffer();
+		std::vector<Uint8> to = createFrame(2).getBuffer();
+		std::vector<Uint8> delta;
+		flat2d::SnapshotHistory::encodeDelta(from, to, &delta);
+
+		std::vector<Uint8> buffer = from;
+		REQUIRE(flat2d::SnapshotHistory::applyDelta(delta, &buffer));
+		REQUIRE(buffer == to);
+
+		// Truncated run data and headers
+		std::vector<Uint8> truncated(delta.begin(), delta.end() - 1);
+		buffer = from;
+		REQUIRE(!flat2d::SnapshotHistory::applyDelta(truncated, &buffer));
+		truncated.resize(2);
+		REQUIRE(!flat2d::SnapshotHistory::applyDelta(truncated, &buffer));
+
+		// A run reaching past the size header
+		std::vector<Uint8> corrupt = delta;
+		Uint32 size = 1;
+		std::memcpy(&corrupt[0], &size, sizeof(size));
+		buffer = from;
+		REQUIRE(!flat2d::SnapshotHistory::applyDelta(corrupt, &buffer));
+	}
+}
@@ -0,0 +1,63 @@
+#include "../src/SpinLock.h"
+#include "catch.hpp"
+#include <thread>
+
+template<typename Lock>
+static void
+countWithThreads(Lock* lock, int* counter)
+{
+	const int thread_count = 4;
+	const int increments = 1000;
+
+	std::thread threads[thread_count];
+	for (auto i = 0; i < thread_count; i++) {
+		threads[i] = std::thread([lock, counter]() {
+			for (auto j = 0; j < increments; j++) {
+				lock->lock();
+				(*counter)++;
+				lock->unlock();
+			}
+		});
+	}
+	for (auto i = 0; i < thread_count; i++) {
+		threads[i].join();
+	}
+}
+
+TEST_CASE("SpinLockTest", "[lock]")
+{
+	int counter = 0;
+
+	SECTION("SpinLock", "[lock]")
+	{
+		flat2d::SpinLock lock;
+		countWithThreads(&lock, &counter);
+		REQUIRE(counter == 4000);
+		REQUIRE(lock.getStats().acquisitions == 4000);
+
+		REQUIRE(lock.try_lock());
+		REQUIRE(!lock.try_lock());
+		lock.unlock();
+	}
+
+	SECTION("TicketLock", "[lock]")
+	{
+		flat2d::TicketLock lock;
+		countWithThreads(&lock, &counter);
+		REQUIRE(counter == 4000);
+		REQUIRE(lock.getStats().acquisitions == 4000);
+	}
+
+	SECTION("HybridMutex", "[lock]")
+	{
+		flat2d::HybridMutex lock;
+		countWithThreads(&lock, &counter);
+		REQUIRE(counter == 4000);
+		REQUIRE(lock.getStats().acquisitions == 4000);
+		REQUIRE(lock.getStats().blocks <= lock.getStats().contentions);
+
+		REQUIRE(lock.try_lock());
+		REQUIRE(!lock.try_lock());
+		lock.unlock();
+	}
+}
@@ -0,0 +1,78 @@
+#include "../src/StaticSpatialIndex.h"
+#include "../src/MapArea.h"
+#include "EntityImpl.h"
+#include "catch.hpp"
+
+TEST_CASE("Static spatial index tests", "[staticindex]")
+{
+	flat2d::StaticSpatialIndex index;
+	index.setDimension(100);
+
+	EntityImpl wall(95, 50);
+	EntityImpl floor(250, 250);
+
+	SECTION("Insert and query", "[staticindex]")
+	{
+		index.insert(&wall);
+		index.insert(&floor);
+
+		REQUIRE(2 == index.size());
+		REQUIRE(3 == index.getEntryCount());
+
+		int count = 0;
+		index.forEachIn(flat2d::MapArea(100, 0, 100),
+		                [&count, &wall](flat2d::Entity* e) {
+			                REQUIRE(*e == wall);
+			                count++;
+		                });
+		REQUIRE(1 == count);
+
+		count = 0;
+		index.forEachIn(flat2d::MapArea(0, 100, 100),
+		                [&count](flat2d::Entity* e) { count++; });
+		REQUIRE(0 == count);
+	}
+
+	SECTION("Remove and rebuild", "[staticindex]")
+	{
+		index.insert(&wall);
+		index.insert(&floor);
+		index.remove(&wall);
+
+		REQUIRE(1 == index.size());
+		REQUIRE(1 == index.getEntryCount());
+
+		index.clear();
+		REQUIRE(0 == index.size());
+		REQUIRE(0 == index.getEntryCount());
+	}
+
+	SECTION("Remove from a built index", "[staticindex]")
+	{
+		index.insert(&wall);
+		index.insert(&floor);
+		REQUIRE(3 == index.getEntryCount());
+
+		index.remove(&wall);
+		index.remove(&wall);
+		REQUIRE(1 == index.size());
+		REQUIRE(1 == index.getEntryCount());
+
+		int count = 0;
+		index.forEachIn(flat2d::MapArea(0, 0, 100),
+		                [&count](flat2d::Entity* e) { count++; });
+		REQUIRE(0 == count);
+		index.forEachIn(flat2d::MapArea(200, 200, 100),
+		                [&count](flat2d::Entity* e) { count++; });
+		REQUIRE(1 == count);
+	}
+
+	SECTION("Large bodies span partitions", "[staticindex]")
+	{
+		flat2d::Entity ground(0, 150, 350, 10);
+		ground.getEntityProperties().setCollidable(true);
+		index.insert(&ground);
+
+		REQUIRE(4 == index.getEntryCount());
+	}
+}
@@ -0,0 +1,55 @@
+#include "../src/TaskScheduler.h"
+#include "catch.hpp"
+#include <string>
+
+TEST_CASE("TaskSchedulerTest", "[scheduler]")
+{
+	flat2d::TaskScheduler scheduler;
+	std::string order;
+	auto append = [&order](char c) {
+		return [&order, c]() {
+			order += c;
+			return true;
+		};
+	};
+
+	SECTION("Priorities", "[scheduler]")
+	{
+		scheduler.submit(append('l'), flat2d::TASK_LOW);
+		scheduler.submit(append('n'));
+		scheduler.submit(append('h'), flat2d::TASK_HIGH);
+		scheduler.submit(append('m'));
+		REQUIRE(scheduler.getPendingCount() == 4);
+
+		REQUIRE(scheduler.run(100.0f) == 4);
+		REQUIRE(order == "hnml");
+		REQUIRE(scheduler.getPendingCount() == 0);
+		REQUIRE(scheduler.getCompletedCount() == 4);
+	}
+
+	SECTION("Sliced tasks", "[scheduler]")
+	{
+		int steps = 0;
+		scheduler.submit([&steps]() { return ++steps == 3; });
+		REQUIRE(scheduler.run(100.0f) == 3);
+		REQUIRE(steps == 3);
+		REQUIRE(scheduler.getPendingCount() == 0);
+	}
+
+	SECTION("Budget", "[scheduler]")
+	{
+		flat2d::TaskId id = scheduler.submit(append('x'));
+		REQUIRE(scheduler.run(0.0f) == 0);
+		REQUIRE(scheduler.getPendingCount() == 1);
+
+		REQUIRE(scheduler.cancel(id));
+		REQUIRE(!scheduler.cancel(id));
+		REQUIRE(scheduler.getPendingCount() == 0);
+
+		// The minimum slice runs tasks without any slack
+		scheduler.setMinimumSlice(100.0f);
+		scheduler.submit(append('y'));
+		REQUIRE(scheduler.run(-5.0f) == 1);
+		REQUIRE(order == "y");
+	}
+}
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <set>
 #include <thread>
+#include <vector>
 
 using namespace flat2d;
 
@@ -34,3 +35,58 @@ TEST_CASE("UID Generation sequence test", "[UID]")
 
 	REQUIRE(idSet.size() == thread_count);
 }
+
+TEST_CASE("UID Generation block test", "[UID]")
+{
+	const int thread_count = 8;
+	const int id_count = 100;
+	std::vector<size_t> ids[thread_count];
+
+	std::thread threads[thread_count];
+	for (auto i = 0; i < thread_count; i++) {
+		threads[i] = std::thread([&ids, i]() {
+			for (auto j = 0; j < id_count; j++) {
+				ids[i].push_back(UID::generate());
+			}
+		});
+	}
+	for (auto i = 0; i < thread_count; i++) {
+		threads[i].join();
+	}
+
+	std::set<size_t> idSet;
+	for (auto i = 0; i < thread_count; i++) {
+		for (auto j = 1; j < id_count; j++) {
+			// Sequential within a thread
+			REQUIRE(ids[i][j] > ids[i][j - 1]);
+		}
+		idSet.insert(ids[i].begin(), ids[i].end());
+	}
+	REQUIRE(idSet.size() == thread_count * id_count);
+}
+
+TEST_CASE("UID Recycling test", "[UID]")
+{
+	size_t first = UID::generate();
+	size_t second = UID::generate();
+
+	UID::release(first);
+	REQUIRE(UID::generate() != first);
+
+	UID::setRecycling(true);
+	REQUIRE(UID::isRecycling());
+	UID::release(second);
+	UID::release(first);
+	REQUIRE(UID::generate() == first);
+	REQUIRE(UID::generate() == second);
+	REQUIRE(UID::generate() > second);
+
+	// A double release must not hand the id out twice
+	UID::release(first);
+	UID::release(first);
+	REQUIRE(UID::generate() == first);
+	REQUIRE(UID::generate() != first);
+
+	UID::setRecycling(false);
+	REQUIRE(!UID::isRecycling());
+}